@@ -10,23 +10,46 @@
  *   Copyright (c) 2019, Jordan Miller
  ********************************************************
 FILE: BPTree.h
-TEMPLATE CLASS PROVIDED: BPTree<Item> (Balanced+ Tree)
+TEMPLATE CLASS PROVIDED: BPTree<Item, Order, Alloc> (Balanced+ Tree)
+    Every node but the root holds between Order and 2 * Order
+    items.  Order defaults to BPTreeOrder<Item>::MINIMUM, which
+    sizes a node's items to a few cache lines.  The items of a
+    node are kept together in one array and the pointers to
+    its children in another, so a search within a node only
+    reads the items.  Each step down the tree prefetches the
+    child's items before they're searched.
+
+    The nodes under the root come from an Alloc<BPTree> (see
+    node_pool.h) which the root makes when the tree first
+    splits and the other nodes share.  The default NodePool
+    packs them into slabs and frees them all at once when the
+    tree is cleared; HeapNodes makes each with new.  A copy of
+    a tree has its own pool.
 
 CONSTRUCTORS:
     BPTree(bool dups = false)
         Postcondition: An empty BPTree has been created.
 
-    BPTree(const BPTree<Item>& other)
+    BPTree(const BPTree<Item, Order, Alloc>& other)
         Precondition: other is a valid BPTree with the same template type.
         Postcondition: The calling BPTree has been created containing the 
                        same information as other.
 
+    BPTree(BPTree<Item, Order, Alloc>&& other)
+        Postcondition: The calling BPTree holds the items of other, which
+                       is empty.  Only the items of other's root are
+                       moved; its children and their pool are handed over.
+
 ASSIGNMENT:
-    BPTree<Item>& operator =(const BPTree<Item>& rhs)
+    BPTree<Item, Order, Alloc>& operator =(const BPTree<Item, Order, Alloc>& rhs)
         Precondition: rhs is a valid BPTree with the template Item.
         Postcondition: The calling BPTree now contains the same
                        data as rhs.
 
+    BPTree<Item, Order, Alloc>& operator =(BPTree<Item, Order, Alloc>&& rhs)
+        Postcondition: The calling BPTree holds the items of rhs, the
+                       same as the move constructor, and rhs is empty.
+
 MUTATORS:
     void insert(const Item& entry)
         Precondition: entry is of type Item.
@@ -35,6 +58,12 @@ MUTATORS:
                        which was equal to entry already existed
                        in the BPTree, then it has been replaced.
 
+    Item& get_or_insert(const Item& entry)
+        Postcondition: A reference to the item equal to entry has been
+                       returned.  If there wasn't one entry has been
+                       inserted first.  Either way the tree is only
+                       walked once.
+
     bool remove(const Item& entry)
         Postcondition: If entry existed in the BPTree,
                        it has been removed and the BPTree
@@ -46,22 +75,31 @@ MUTATORS:
                        the children of the BPTree has been realsed to
                        the heap.
 
-    void copy_tree(const BPTree<Item>& other)
+    void copy_tree(const BPTree<Item, Order, Alloc>& other)
         Precondition: other is a valid BPTree
         Postcondition: The calling tree now contains the same data
                        as other.
 
+    void bulk_load(const Item* items, int count)
+        Precondition: items holds count Items in increasing order with
+                      no duplicates.
+        Postcondition: The calling tree has been rebuilt to hold exactly
+                       items.  The tree is built bottom up, so every
+                       leaf is full except at most the last two rather
+                       than being left half full by repeated splits.
+
 // ACCESSORS
 
     bool contains(const Item& target)
         Postcondition: a bool has been returned indicating the existance
                        of target in the BPTree.
 
-    Item& get(const Item& target)
+    Item& get(const Item& target) *** has const version ***
         Postcondition: Returns a reference to the item equal to target.
 
     Item* find(const Item& target)
-        Postcondition: Returns a pointer to the item equal to target.
+        Postcondition: Returns a pointer to the item equal to target, or
+                       NULL if there is none.  The tree is walked once.
 
     int size() const
         Postcondition: Returns the number of items in the BPTree.
@@ -80,9 +118,27 @@ MUTATORS:
 #include <iostream>
 #include <iomanip>
 #include <cstdlib>
+#include <new>
+#include <utility>
 #include "./array_functions.h"
-
+#include "./node_pool.h"
+#include "./vector.h"
+
+// The least number of items a node of a BPTree of Item
+// holds by default.  It's picked so a node's items take
+// up about NODE_BYTES, a few cache lines, so a large Item
+// gets a smaller node.  A key type can be given its own
+// order by specializing this.
 template <typename Item>
+struct BPTreeOrder
+{
+    static const int NODE_BYTES = 512;
+    static const int BY_SIZE = NODE_BYTES / (2 * sizeof(Item));
+    static const int MINIMUM = BY_SIZE < 1 ? 1 : (BY_SIZE > 32 ? 32 : BY_SIZE);
+};
+
+template <typename Item, int Order = BPTreeOrder<Item>::MINIMUM,
+          template <class> class Alloc = NodePool>
 class BPTree
 {
 public:
@@ -90,9 +146,9 @@ public:
     {
     public:
         friend class BPTree;
-        Iterator(BPTree<Item>* _it=NULL, int _key_ptr = 0):it(_it), key_ptr(_key_ptr){}
+        Iterator(BPTree<Item, Order, Alloc>* _it=NULL, int _key_ptr = 0):it(_it), key_ptr(_key_ptr){}
 
-        Item operator *()
+        const Item& operator *()
         {
             // std::cout << "Key_ptr: " << key_ptr << " data_count: " << it->data_count << std::endl;
             assert(key_ptr < it->data_count);
@@ -114,9 +170,16 @@ public:
                 ++key_ptr;
             else
             {
+                // The leaf after the next one is fetched
+                // while the items of the next are read
                 it = it->next;
                 key_ptr = 0;
+
+                if (it != NULL && it->next != NULL)
+                    it->next->prefetch();
             }
+
+            return *this;
         }
 
         friend bool operator ==(const Iterator& lhs, const Iterator& rhs)
@@ -132,68 +195,84 @@ public:
         }
         bool is_null(){return !it;}
     private:
-        BPTree<Item>* it;
+        BPTree<Item, Order, Alloc>* it;
         int key_ptr;
     };
 
 
     // CONSTRUCTORS
     BPTree(bool dups = false);
-    BPTree(const BPTree<Item>& other);
+    BPTree(const BPTree<Item, Order, Alloc>& other);
+    BPTree(BPTree<Item, Order, Alloc>&& other);
 
     // DESTRUCTOR
     ~BPTree();
 
     // ASSIGNEMENT
-    BPTree<Item>& operator =(const BPTree<Item>& rhs);
+    BPTree<Item, Order, Alloc>& operator =(const BPTree<Item, Order, Alloc>& rhs);
+    BPTree<Item, Order, Alloc>& operator =(BPTree<Item, Order, Alloc>&& rhs);
 
     // MUTATORS
     void insert(const Item& entry);              
+    Item& get_or_insert(const Item& entry);
     bool remove(const Item& entry);             
     void clear_tree();                        
-    void copy_tree(const BPTree<Item>& other, BPTree<Item>*& last_leaf = NULL);     
+    void copy_tree(const BPTree<Item, Order, Alloc>& other, BPTree<Item, Order, Alloc>*& last_leaf = NULL);     
+    void bulk_load(const Item* items, int count);
 
     // ACCESSORS
     bool contains(const Item& target) const;             
     Item& get(const Item& target);                     
+    const Item& get(const Item& target) const;
     Item* find(const Item& target);                
     int size() const;                       
     bool empty() const { return data_count == 0; }                        
     void print_tree(int level = 0, std::ostream &outs = std::cout) const;
     bool is_valid(); 
-    friend std::ostream& operator<<(std::ostream& outs, const BPTree<Item>& print_me)
+    friend std::ostream& operator<<(std::ostream& outs, const BPTree<Item, Order, Alloc>& print_me)
     {
         print_me.print_tree(0, outs);
         return outs;
     }
 
     // ITERATOR FUNCTIONS
-    typename BPTree<Item>::Iterator begin();
-    typename BPTree<Item>::Iterator at(Item target);
-    typename BPTree<Item>::Iterator end();
-    typename BPTree<Item>::Iterator upper_bound(const Item& key);
-    typename BPTree<Item>::Iterator lower_bound(const Item& key);
+    typename BPTree<Item, Order, Alloc>::Iterator begin();
+    typename BPTree<Item, Order, Alloc>::Iterator at(Item target);
+    typename BPTree<Item, Order, Alloc>::Iterator end();
+    typename BPTree<Item, Order, Alloc>::Iterator upper_bound(const Item& key);
+    typename BPTree<Item, Order, Alloc>::Iterator lower_bound(const Item& key);
 
 
 // private:
 
     // STATIC MEMBER VARIABLES
-    static const int MINIMUM = 1;
+    static const int MINIMUM = Order;
     static const int MAXIMUM = 2 * MINIMUM;
 
+    typedef Alloc<BPTree<Item, Order, Alloc> > Pool;
+
     // PRIVATE MEMBER VARIABLES
     bool dups_ok;                                   
     int data_count;                               
     Item data[MAXIMUM + 1];                         
     int child_count;                               
-    BPTree<Item>* subset[MAXIMUM + 2];
-    BPTree<Item>* next;                    
+    BPTree<Item, Order, Alloc>* subset[MAXIMUM + 2];
+    BPTree<Item, Order, Alloc>* next;                    
+    Pool* pool;
+    bool owns_pool;
 
     // PRIVATE MEMBER FUNCTIONS
-    BPTree<Item>* get_smallest_node();
+    BPTree(bool dups, Pool* shared);
+    BPTree<Item, Order, Alloc>* new_node();
+    void delete_node(BPTree<Item, Order, Alloc>* node);
+    void take_tree(BPTree<Item, Order, Alloc>& other);
+    BPTree<Item, Order, Alloc>* get_smallest_node();
     bool is_leaf() const { return child_count == 0; }   
-    void loose_insert(const Item& entry);             
+    void prefetch() const;
+    Item* root_insert(const Item& entry, bool replace);
+    Item* loose_insert(const Item& entry, bool replace);
     void fix_excess(int i);                        
+    Item* split_leaf_item(int i, const Item& entry);
     bool loose_remove(const Item& entry);
     bool remove_sister(const Item& entry);             
     void fix_shortage(int i);                      
@@ -201,110 +280,156 @@ public:
     void rotate_left(int index);                       
     void rotate_right(int index);                      
     void merge_with_next_subset(int index);             
+    static jmiller::Vector<int> group_sizes(int count, int most, int least);
 
 };
 
 // CONSTRUCTORS
-template<typename Item>
-BPTree<Item>::BPTree(bool dupes)
+template<typename Item, int Order, template <class> class Alloc>
+BPTree<Item, Order, Alloc>::BPTree(bool dupes)
+{
+    data_count = 0;
+    child_count = 0;
+    next = NULL;
+    dups_ok = dupes;
+    pool = NULL;
+    owns_pool = true;
+}
+
+// A node under the root, which shares the root's pool
+template<typename Item, int Order, template <class> class Alloc>
+BPTree<Item, Order, Alloc>::BPTree(bool dupes, Pool* shared)
 {
     data_count = 0;
     child_count = 0;
     next = NULL;
     dups_ok = dupes;
+    pool = shared;
+    owns_pool = false;
 }
 
-template<typename Item>
-BPTree<Item>::BPTree(const BPTree<Item>& other)
+template<typename Item, int Order, template <class> class Alloc>
+BPTree<Item, Order, Alloc>::BPTree(const BPTree<Item, Order, Alloc>& other)
 {
     this->dups_ok = other.dups_ok;
     data_count = 0;
     child_count = 0;
-    BPTree<Item>* ptr = NULL;
+    next = NULL;
+    pool = NULL;
+    owns_pool = true;
+    BPTree<Item, Order, Alloc>* ptr = NULL;
     copy_tree(other, ptr);
 }
 
+template<typename Item, int Order, template <class> class Alloc>
+BPTree<Item, Order, Alloc>::BPTree(BPTree<Item, Order, Alloc>&& other)
+{
+    this->dups_ok = other.dups_ok;
+    data_count = 0;
+    child_count = 0;
+    next = NULL;
+    pool = NULL;
+    owns_pool = true;
+    take_tree(other);
+}
+
 // DESTRUCTOR
-template<typename Item>
-BPTree<Item>::~BPTree()
+template<typename Item, int Order, template <class> class Alloc>
+BPTree<Item, Order, Alloc>::~BPTree()
 {
     this->clear_tree();
+
+    if (owns_pool)
+        delete pool;
 }
 
 // ASSIGNEMENT
-template<typename Item>
-BPTree<Item>& BPTree<Item>::operator=(const BPTree<Item>& rhs)
+template<typename Item, int Order, template <class> class Alloc>
+BPTree<Item, Order, Alloc>& BPTree<Item, Order, Alloc>::operator=(const BPTree<Item, Order, Alloc>& rhs)
 {
+    if (this == &rhs)
+        return *this;
+
     this->clear_tree();
-    BPTree<Item>* ptr = NULL;
+    this->dups_ok = rhs.dups_ok;
+    BPTree<Item, Order, Alloc>* ptr = NULL;
     this->copy_tree(rhs, ptr);
     return *this;
 }
 
-// MUTATORS
-template<typename Item>
-void BPTree<Item>::insert(const Item& entry)
+template<typename Item, int Order, template <class> class Alloc>
+BPTree<Item, Order, Alloc>& BPTree<Item, Order, Alloc>::operator=(BPTree<Item, Order, Alloc>&& rhs)
 {
-    loose_insert(entry);
-
-    if (data_count > MAXIMUM)
-    {
-        BPTree<Item>* new_child;
-        new_child = new BPTree<Item>(dups_ok);
+    if (this == &rhs)
+        return *this;
 
-        // Copy data into new child
-        copy_array(new_child->data, data, new_child->data_count, data_count);
-        // Copy subset into new child
-        copy_array(new_child->subset, subset, new_child->child_count, child_count);
+    // The nodes of this tree go with its pool,
+    // and rhs brings its own
+    this->clear_tree();
+    delete pool;
+    pool = NULL;
 
-        data_count = 0;
-        child_count = 1;
+    take_tree(rhs);
+    return *this;
+}
 
-        subset[0] = new_child;
+// MUTATORS
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::insert(const Item& entry)
+{
+    root_insert(entry, true);
+}
 
-        fix_excess(0);
-    }
+template<typename Item, int Order, template <class> class Alloc>
+Item& BPTree<Item, Order, Alloc>::get_or_insert(const Item& entry)
+{
+    return *root_insert(entry, false);
 }
 
-template<typename Item>
-bool BPTree<Item>::remove(const Item& entry)
+template<typename Item, int Order, template <class> class Alloc>
+bool BPTree<Item, Order, Alloc>::remove(const Item& entry)
 {
     if (!loose_remove(entry))
         return false;
     
     if (data_count == 0 && child_count == 1)
     {
-        BPTree<Item>* temp;
+        BPTree<Item, Order, Alloc>* temp;
         temp = this->subset[0];
 
-        copy_array(this->data,
+        move_array(this->data,
                    temp->data,
                    this->data_count,
                    temp->data_count);
 
-        copy_array(this->subset,
+        move_array(this->subset,
                    temp->subset,
                    this->child_count,
                    temp->child_count);
 
+        // A leaf which moves up to the root was the only leaf
+        next = temp->next;
+
         for (int i = 0; i < temp->child_count; i++)
             temp->subset[i] = NULL;
 
         temp->child_count = temp->data_count = 0;
 
-        delete temp;        
+        delete_node(temp);        
     }
     return true;
 }
 
-template<typename Item>
-void BPTree<Item>::clear_tree()
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::clear_tree()
 {
     for (int i = 0; i < child_count; i++)
-    {
-        subset[i]->clear_tree();
-        delete subset[i];
-    }
+        delete_node(subset[i]);
+
+    // Every node is gone so the root
+    // frees their slabs all at once
+    if (owns_pool && pool != NULL)
+        pool->release();
 
     // Clears the data for the root, redundantly applied to
     // the dynamic nodes which are about to be deleted.
@@ -315,10 +440,11 @@ void BPTree<Item>::clear_tree()
 }
 
 
-template<typename Item>
-void BPTree<Item>::copy_tree(const BPTree<Item>& other, BPTree<Item>*& last_leaf)
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::copy_tree(const BPTree<Item, Order, Alloc>& other, BPTree<Item, Order, Alloc>*& last_leaf)
 {
     this->clear_tree();
+    next = NULL;
 
     copy_array(this->data, other.data, this->data_count, other.data_count);
     this->child_count = other.child_count;
@@ -327,7 +453,7 @@ void BPTree<Item>::copy_tree(const BPTree<Item>& other, BPTree<Item>*& last_leaf
     {
         for (int i = 0; i < other.child_count; i++)
         {
-            subset[i] = new BPTree<Item>(dups_ok);            
+            subset[i] = new_node();            
             subset[i]->copy_tree(*other.subset[i], last_leaf);
         }
     }
@@ -343,10 +469,102 @@ void BPTree<Item>::copy_tree(const BPTree<Item>& other, BPTree<Item>*& last_leaf
     }
 }
 
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::bulk_load(const Item* items, int count)
+{
+    jmiller::Vector<BPTree<Item, Order, Alloc>*> level;
+    jmiller::Vector<BPTree<Item, Order, Alloc>*> parents;
+    jmiller::Vector<Item> smallest;
+    jmiller::Vector<Item> parent_smallest;
+    jmiller::Vector<int> sizes;
+    BPTree<Item, Order, Alloc>* node;
+    int pos;
+
+    this->clear_tree();
+    next = NULL;
+
+    // Few enough items for the root to be the only leaf
+    if (count <= MAXIMUM)
+    {
+        for (int i = 0; i < count; i++)
+            data[i] = items[i];
+
+        data_count = count;
+        return;
+    }
+
+    // Packs the items into full leaves linked left to right,
+    // remembering the smallest item of each leaf
+    sizes = group_sizes(count, MAXIMUM, MINIMUM);
+    pos = 0;
+
+    for (int i = 0; i < sizes.size(); i++)
+    {
+        node = new_node();
+
+        for (int j = 0; j < sizes[i]; j++)
+            node->data[j] = items[pos + j];
+
+        node->data_count = sizes[i];
+
+        if (i > 0)
+            level[i - 1]->next = node;
+
+        level.push_back(node);
+        smallest.push_back(items[pos]);
+        pos += sizes[i];
+    }
+
+    // Builds each level of parents from the level below until
+    // the nodes left will fit under the root.  A parent's data
+    // holds the smallest item under each of its children but
+    // the first, the same as the splits in fix_excess() leave.
+    while (level.size() > MAXIMUM + 1)
+    {
+        sizes = group_sizes(level.size(), MAXIMUM + 1, MINIMUM + 1);
+        parents.clear();
+        parent_smallest.clear();
+        pos = 0;
+
+        for (int i = 0; i < sizes.size(); i++)
+        {
+            node = new_node();
+
+            for (int j = 0; j < sizes[i]; j++)
+            {
+                node->subset[j] = level[pos + j];
+                if (j > 0)
+                    node->data[j - 1] = smallest[pos + j];
+            }
+
+            node->child_count = sizes[i];
+            node->data_count = sizes[i] - 1;
+
+            parents.push_back(node);
+            parent_smallest.push_back(smallest[pos]);
+            pos += sizes[i];
+        }
+
+        level = parents;
+        smallest = parent_smallest;
+    }
+
+    // The root is this object so it takes the last level directly
+    for (int i = 0; i < level.size(); i++)
+    {
+        subset[i] = level[i];
+        if (i > 0)
+            data[i - 1] = smallest[i];
+    }
+
+    child_count = level.size();
+    data_count = child_count - 1;
+}
+
 // ACCESSORS
 
-template<typename Item>
-bool BPTree<Item>::contains(const Item& target) const
+template<typename Item, int Order, template <class> class Alloc>
+bool BPTree<Item, Order, Alloc>::contains(const Item& target) const
 {
     int index;
     bool found;
@@ -355,26 +573,40 @@ bool BPTree<Item>::contains(const Item& target) const
     if (found && this->is_leaf())
         return true;
     else if (found && !this->is_leaf())
+    {
+        subset[index + 1]->prefetch();
         return subset[index + 1]->contains(target);
+    }
     else if (!found && !this->is_leaf())
+    {
+        subset[index]->prefetch();
         return subset[index]->contains(target);
+    }
     else
         return false;
 }
 
-template<typename Item>
-Item* BPTree<Item>::find(const Item& target)
+template<typename Item, int Order, template <class> class Alloc>
+Item* BPTree<Item, Order, Alloc>::find(const Item& target)
 {
-    assert(this->contains(target));
+    int index;
+    bool found;
+    index = first_ge(data, data_count, target);
+    found = (index < data_count && data[index] == target);
 
-    Item* ptr;
+    if (this->is_leaf())
+        return found ? &data[index] : NULL;
 
-    ptr = &this->get(target);
-    return ptr;
+    // An equal key in a node starts the child after it
+    if (found)
+        index++;
+
+    subset[index]->prefetch();
+    return subset[index]->find(target);
 }
 
-template<typename Item>
-int BPTree<Item>::size() const
+template<typename Item, int Order, template <class> class Alloc>
+int BPTree<Item, Order, Alloc>::size() const
 {
     int size;
     size = data_count;
@@ -385,26 +617,47 @@ int BPTree<Item>::size() const
     return size;
 }
 
-template<typename Item>
-Item& BPTree<Item>::get(const Item& target)
+template<typename Item, int Order, template <class> class Alloc>
+Item& BPTree<Item, Order, Alloc>::get(const Item& target)
 {
     int index;
     bool found;
     index = first_ge(data, data_count, target);
-    found = (data[index] == target && index < data_count);
+    found = (index < data_count && data[index] == target);
 
     if (found && this->is_leaf())
         return data[index];
     else if (found && !this->is_leaf())
+    {
+        subset[index + 1]->prefetch();
         return subset[index + 1]->get(target);
+    }
     else if (!found && !this->is_leaf())
+    {
+        subset[index]->prefetch();
         return subset[index]->get(target);
+    }
     else
+    {
+        // Asking for an item which isn't there is the caller's
+        // mistake.  The slot it would be in, which is always
+        // inside the node's array, is returned rather than
+        // leaving the result undefined.
         std::cout << "Item is not in tree." << std::endl;
+        assert(false);
+        return data[index];
+    }
+}
+
+template<typename Item, int Order, template <class> class Alloc>
+const Item& BPTree<Item, Order, Alloc>::get(const Item& target) const
+{
+    // The descent doesn't change the tree
+    return const_cast<BPTree<Item, Order, Alloc>*>(this)->get(target);
 }
 
-template<typename Item>
-void BPTree<Item>::print_tree(int level, std::ostream& outs) const
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::print_tree(int level, std::ostream& outs) const
 {
     if (!is_leaf())
     {
@@ -424,25 +677,28 @@ void BPTree<Item>::print_tree(int level, std::ostream& outs) const
 
 // PRIVATE HELPER FUNCTIONS
 
-template<typename Item>
-bool BPTree<Item>::loose_remove(const Item& target)
+template<typename Item, int Order, template <class> class Alloc>
+bool BPTree<Item, Order, Alloc>::loose_remove(const Item& target)
 {
     Item hold;
     int index;
     bool found;
     index = first_ge(data, data_count, target);
 
-    if (child_count == 0 && data[index] != target || 
-        child_count == 0 && index >= data_count)
+    // The slot past the last item may hold an old item,
+    // so it's only compared when it's in the node
+    found = index < data_count && data[index] == target;
+
+    if (child_count == 0 && !found)
     {
         return false;
     }
-    else if (child_count == 0 && data[index] == target)
+    else if (child_count == 0 && found)
     {
         delete_item(data, index, data_count, hold);
         return true;
     }
-    else if(child_count > 0 && data[index] != target)
+    else if(child_count > 0 && !found)
     {
         found = subset[index]->loose_remove(target);
         
@@ -451,20 +707,25 @@ bool BPTree<Item>::loose_remove(const Item& target)
         
         return found;
     }
-    else if(child_count > 0 && data[index] == target)
+    else if(child_count > 0 && found)
     {
-        subset[index + 1]->loose_remove(target);
+        // The item may already be gone from the leaf,
+        // leaving its copy here behind
+        found = subset[index + 1]->loose_remove(target);
         if (subset[index + 1]->data_count < MINIMUM)
             fix_shortage(index + 1);
         
-        return true;
+        return found;
     }
     else
-        std::cout << "Something went wrong in loose_remove()" << std::endl;   
+    {
+        std::cout << "Something went wrong in loose_remove()" << std::endl;
+        return false;
+    }
 }
 
-template<typename Item>
-void BPTree<Item>::remove_biggest(Item& removed_entry)
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::remove_biggest(Item& removed_entry)
 {
     if (child_count == 0)
     {
@@ -479,8 +740,8 @@ void BPTree<Item>::remove_biggest(Item& removed_entry)
     }
 }
 
-template<typename Item>
-void BPTree<Item>::fix_shortage(int i)
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::fix_shortage(int i)
 {
     Item hold;
     BPTree* tree_hold;
@@ -526,13 +787,15 @@ void BPTree<Item>::fix_shortage(int i)
     {
         if (subset[i]->is_leaf())
         {
+            // A leaf takes the item itself rather than data[i],
+            // which may be left over from a removed item
+            delete_item(subset[i + 1]->data,
+                        0, subset[i + 1]->data_count,
+                        hold);
+
             insert_item(subset[i]->data, 
                         subset[i]->data_count,
                         subset[i]->data_count,
-                        data[i]);
-
-            delete_item(subset[i + 1]->data,
-                        0, subset[i + 1]->data_count,
                         hold);
 
             data[i] = subset[i + 1]->data[0];
@@ -579,7 +842,7 @@ void BPTree<Item>::fix_shortage(int i)
             subset[i - 1]->next = subset[i]->next;
 
             delete_item(subset, i, child_count, tree_hold);
-            delete tree_hold;
+            delete_node(tree_hold);
 
         }
         else
@@ -599,7 +862,7 @@ void BPTree<Item>::fix_shortage(int i)
                 subset[i]->child_count);
 
             delete_item(subset, i, child_count, tree_hold);
-            delete tree_hold;
+            delete_node(tree_hold);
         }      
     }
     // Case 4: Combine subset[i] with subset[i + 1]
@@ -615,11 +878,11 @@ void BPTree<Item>::fix_shortage(int i)
                 subset[i + 1]->data,
                 subset[i + 1]->data_count);
 
-            delete_item(subset, i, child_count, tree_hold);
-            delete tree_hold;
+            // The emptied leaf is the one taken out
+            subset[i]->next = subset[i + 1]->next;
 
-            if (i > 0)
-                subset[i - 1]->next = subset[i];
+            delete_item(subset, i + 1, child_count, tree_hold);
+            delete_node(tree_hold);
         }
         else
         {
@@ -638,7 +901,7 @@ void BPTree<Item>::fix_shortage(int i)
                 subset[i + 1]->child_count);
 
             delete_item(subset, i + 1, child_count, tree_hold);
-            delete tree_hold;
+            delete_node(tree_hold);
         }
         
     }
@@ -648,14 +911,14 @@ void BPTree<Item>::fix_shortage(int i)
     }
 }
 
-template<typename Item>
-void BPTree<Item>::fix_excess(int index)
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::fix_excess(int index)
 {
     Item mid;
     mid = subset[index]->data[(MAXIMUM + 1) / 2];
 
-    BPTree<Item>* new_child;
-    new_child = new BPTree<Item>(dups_ok);
+    BPTree<Item, Order, Alloc>* new_child;
+    new_child = new_node();
 
     // Split the data array between the 2 children
     split(subset[index]->data,
@@ -686,45 +949,94 @@ void BPTree<Item>::fix_excess(int index)
     }
 }
 
-template<typename Item>
-void BPTree<Item>::loose_insert(const Item& entry)
+template<typename Item, int Order, template <class> class Alloc>
+Item* BPTree<Item, Order, Alloc>::root_insert(const Item& entry, bool replace)
+{
+    Item* item;
+    item = loose_insert(entry, replace);
+
+    if (data_count > MAXIMUM)
+    {
+        BPTree<Item, Order, Alloc>* new_child;
+        new_child = new_node();
+
+        // Move data into new child
+        move_array(new_child->data, data, new_child->data_count, data_count);
+        // Move subset into new child
+        move_array(new_child->subset, subset, new_child->child_count, child_count);
+
+        data_count = 0;
+        child_count = 1;
+
+        subset[0] = new_child;
+
+        fix_excess(0);
+
+        if (subset[0]->is_leaf())
+            item = split_leaf_item(0, entry);
+    }
+
+    return item;
+}
+
+template<typename Item, int Order, template <class> class Alloc>
+Item* BPTree<Item, Order, Alloc>::loose_insert(const Item& entry, bool replace)
 {
     int i;
     bool found;
+    Item* item;
     i = first_ge(data, data_count, entry);
     found = (i < data_count && data[i] == entry);
 
     // Found and is a leaf
     if (found && this->is_leaf())
     {
-        data[i] = entry;     
+        if (replace)
+            data[i] = entry;
+        return &data[i];
     }
     // Not found and is a leaf 
     else if (!found && this->is_leaf())
-        insert_item(data, i, data_count, entry);   
-    // Not found and not a leaf 
-    else if (!found && !this->is_leaf())
-    {
-        subset[i]->loose_insert(entry);
-        if (subset[i]->data_count > MAXIMUM)
-            this->fix_excess(i);
-    }
-    // Found and not a leaf
-    else if (found && !this->is_leaf())
     {
-        subset[i + 1]->loose_insert(entry);
-        if (subset[i + 1]->data_count > MAXIMUM)
-            this->fix_excess(i);
+        insert_item(data, i, data_count, entry);
+        return &data[i];
     }
-    // Shouldn't happen
-    else
+
+    // The entry goes under the child after an equal key
+    if (found)
+        i++;
+
+    subset[i]->prefetch();
+    item = subset[i]->loose_insert(entry, replace);
+
+    // Only a leaf's items move when it's split, the
+    // split of a node above it just moves its pointer
+    if (subset[i]->data_count > MAXIMUM)
     {
-        std::cout << "Something went wrong in loose_insert()" << std::endl;
+        this->fix_excess(i);
+
+        if (subset[i]->is_leaf())
+            item = split_leaf_item(i, entry);
     }
+
+    return item;
+}
+
+template<typename Item, int Order, template <class> class Alloc>
+Item* BPTree<Item, Order, Alloc>::split_leaf_item(int i, const Item& entry)
+{
+    BPTree<Item, Order, Alloc>* leaf;
+    int index;
+
+    // The leaf subset[i] was split at data[i], which
+    // starts the leaf after it
+    leaf = (entry < data[i]) ? subset[i] : subset[i + 1];
+    index = first_ge(leaf->data, leaf->data_count, entry);
+    return &leaf->data[index];
 }
 
-template<typename Item>
-bool BPTree<Item>::is_valid()
+template<typename Item, int Order, template <class> class Alloc>
+bool BPTree<Item, Order, Alloc>::is_valid()
 {
     bool valid;
     valid = true;
@@ -753,8 +1065,93 @@ bool BPTree<Item>::is_valid()
     return valid;
 }
 
-template<typename Item>
-BPTree<Item>* BPTree<Item>::get_smallest_node()  
+template<typename Item, int Order, template <class> class Alloc>
+jmiller::Vector<int> BPTree<Item, Order, Alloc>::group_sizes(int count, int most, int least)
+{
+    jmiller::Vector<int> sizes;
+    int groups;
+    int last;
+
+    // Fills every group but the last.  If the last group would
+    // be too small, the one before it gives up enough to fill it.
+    groups = (count + most - 1) / most;
+    last = count - most * (groups - 1);
+
+    for (int i = 0; i < groups - 1; i++)
+        sizes.push_back(most);
+
+    if (last < least && groups > 1)
+    {
+        sizes[groups - 2] -= least - last;
+        last = least;
+    }
+
+    sizes.push_back(last);
+    return sizes;
+}
+
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::prefetch() const
+{
+#if defined(__GNUC__) || defined(__clang__)
+    const char* first;
+    const char* last;
+
+    // Asks for every cache line of the node's items so
+    // they're on their way before the search reads them
+    first = (const char*)data;
+    last = (const char*)(data + MAXIMUM + 1);
+
+    for (const char* line = first; line < last; line += 64)
+        __builtin_prefetch(line);
+#endif
+}
+
+template<typename Item, int Order, template <class> class Alloc>
+BPTree<Item, Order, Alloc>* BPTree<Item, Order, Alloc>::new_node()
+{
+    // Only the root is without a pool, until its first split
+    if (pool == NULL)
+        pool = new Pool;
+
+    return new (pool->allocate()) BPTree<Item, Order, Alloc>(dups_ok, pool);
+}
+
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::delete_node(BPTree<Item, Order, Alloc>* node)
+{
+    node->~BPTree();
+    pool->deallocate(node);
+}
+
+template<typename Item, int Order, template <class> class Alloc>
+void BPTree<Item, Order, Alloc>::take_tree(BPTree<Item, Order, Alloc>& other)
+{
+    // Only the root's items are moved.  The nodes under
+    // it are handed over whole along with their pool.
+    for (int i = 0; i < other.data_count; i++)
+        data[i] = std::move(other.data[i]);
+
+    for (int i = 0; i < other.child_count; i++)
+    {
+        subset[i] = other.subset[i];
+        other.subset[i] = NULL;
+    }
+
+    // The tree's duplicate policy goes with its items
+    dups_ok = other.dups_ok;
+    data_count = other.data_count;
+    child_count = other.child_count;
+    next = other.next;
+    pool = other.pool;
+
+    other.data_count = other.child_count = 0;
+    other.next = NULL;
+    other.pool = NULL;
+}
+
+template<typename Item, int Order, template <class> class Alloc>
+BPTree<Item, Order, Alloc>* BPTree<Item, Order, Alloc>::get_smallest_node()
 {
     if (this->is_leaf())
         return this;
@@ -762,18 +1159,22 @@ BPTree<Item>* BPTree<Item>::get_smallest_node()
         return subset[0]->get_smallest_node();
 }
 
-template<typename Item>
-typename BPTree<Item>::Iterator BPTree<Item>::begin() 
+template<typename Item, int Order, template <class> class Alloc>
+typename BPTree<Item, Order, Alloc>::Iterator BPTree<Item, Order, Alloc>::begin() 
 {
+    // An empty tree has no first item to point to
+    if (empty())
+        return end();
+
     return Iterator(get_smallest_node());
 }
 
-template<typename Item>
-typename BPTree<Item>::Iterator BPTree<Item>::at(Item target) 
+template<typename Item, int Order, template <class> class Alloc>
+typename BPTree<Item, Order, Alloc>::Iterator BPTree<Item, Order, Alloc>::at(Item target) 
 {
     assert (this->contains(target));
 
-    typename BPTree<Item>::Iterator iter(this);
+    typename BPTree<Item, Order, Alloc>::Iterator iter(this);
     int index;
 
     while (!iter.it->is_leaf())
@@ -781,10 +1182,12 @@ typename BPTree<Item>::Iterator BPTree<Item>::at(Item target)
 
         index = first_ge(iter.it->data, iter.it->data_count, target);
 
-        if (iter.it->data[index] == target)
+        if (index < iter.it->data_count && iter.it->data[index] == target)
             iter = iter.it->subset[index + 1];
         else
             iter = iter.it->subset[index];
+
+        iter.it->prefetch();
     }
 
     iter.key_ptr = first_ge(iter.it->data, iter.it->data_count, target);
@@ -792,16 +1195,16 @@ typename BPTree<Item>::Iterator BPTree<Item>::at(Item target)
 
 }
 
-template<typename Item>
-typename BPTree<Item>::Iterator BPTree<Item>::end() 
+template<typename Item, int Order, template <class> class Alloc>
+typename BPTree<Item, Order, Alloc>::Iterator BPTree<Item, Order, Alloc>::end() 
 {
     return Iterator(NULL);
 }
 
-template<typename Item>
-typename BPTree<Item>::Iterator BPTree<Item>::upper_bound(const Item& key)
+template<typename Item, int Order, template <class> class Alloc>
+typename BPTree<Item, Order, Alloc>::Iterator BPTree<Item, Order, Alloc>::upper_bound(const Item& key)
 {
-    typename BPTree<Item>::Iterator iter(this);
+    typename BPTree<Item, Order, Alloc>::Iterator iter(this);
     int index = 0;
 
     while (!iter.it->is_leaf())
@@ -813,6 +1216,8 @@ typename BPTree<Item>::Iterator BPTree<Item>::upper_bound(const Item& key)
             iter = iter.it->subset[index + 1];
         else
             iter = iter.it->subset[index];
+
+        iter.it->prefetch();
     }
 
     iter.key_ptr = index = first_ge(iter.it->data, iter.it->data_count, key);
@@ -826,10 +1231,10 @@ typename BPTree<Item>::Iterator BPTree<Item>::upper_bound(const Item& key)
     
 }
 
-template<typename Item>
-typename BPTree<Item>::Iterator BPTree<Item>::lower_bound(const Item& key)
+template<typename Item, int Order, template <class> class Alloc>
+typename BPTree<Item, Order, Alloc>::Iterator BPTree<Item, Order, Alloc>::lower_bound(const Item& key)
 {
-    typename BPTree<Item>::Iterator iter(this);
+    typename BPTree<Item, Order, Alloc>::Iterator iter(this);
     int index = 0;
 
     while (!iter.it->is_leaf())
@@ -841,6 +1246,8 @@ typename BPTree<Item>::Iterator BPTree<Item>::lower_bound(const Item& key)
             iter = iter.it->subset[index + 1];
         else
             iter = iter.it->subset[index];
+
+        iter.it->prefetch();
     }
 
     iter.key_ptr = index = first_ge(iter.it->data, iter.it->data_count, key);
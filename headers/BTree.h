@@ -10,19 +10,22 @@
  *   Copyright (c) 2019, Jordan Miller
  ********************************************************
 FILE: BTree.h
-TEMPLATE CLASS PROVIDED: BTree<Item> (Balanced Tree)
+TEMPLATE CLASS PROVIDED: BTree<Item, Alloc> (Balanced Tree)
+    The nodes under the root come from an Alloc<BTree> (see
+    node_pool.h) which the root makes when the tree first
+    splits and the other nodes share, the same as a BPTree.
 
 CONSTRUCTORS:
     BTree(bool dups = false)
         Postcondition: An empty BTree has been created.
 
-    BTree(const BTree<Item>& other)
+    BTree(const BTree<Item, Alloc>& other)
         Precondition: other is a valid BTree with the same template type.
         Postcondition: The calling BTree has been created containing the 
                        same information as other.
 
 ASSIGNMENT:
-    BTree<Item>& operator =(const BTree<Item>& rhs)
+    BTree<Item, Alloc>& operator =(const BTree<Item, Alloc>& rhs)
         Precondition: rhs is a valid BTree with the template Item.
         Postcondition: The calling BTree now contains the same
                        data as rhs.
@@ -46,7 +49,7 @@ MUTATORS:
                        the children of the BTree has been realsed to
                        the heap.
 
-    void copy_tree(const BTree<Item>& other)
+    void copy_tree(const BTree<Item, Alloc>& other)
         Precondition: other is a valid BTree
         Postcondition: The calling tree now contains the same data
                        as other.
@@ -80,28 +83,30 @@ MUTATORS:
 #include <iostream>
 #include <iomanip>
 #include <cstdlib>
+#include <new>
 #include "./array_functions.h"
+#include "./node_pool.h"
 
-template <typename Item>
+template <typename Item, template <class> class Alloc = NodePool>
 class BTree
 {
 public:
 
     // CONSTRUCTORS
     BTree(bool dups = false);
-    BTree(const BTree<Item>& other);
+    BTree(const BTree<Item, Alloc>& other);
 
     // DESTRUCTOR
     ~BTree();
 
     // ASSIGNEMENT
-    BTree<Item>& operator =(const BTree<Item>& rhs);
+    BTree<Item, Alloc>& operator =(const BTree<Item, Alloc>& rhs);
 
     // MUTATORS
     void insert(const Item& entry);              
     bool remove(const Item& entry);             
     void clear_tree();                        
-    void copy_tree(const BTree<Item>& other);     
+    void copy_tree(const BTree<Item, Alloc>& other);     
 
     // ACCESSORS
     bool contains(const Item& target) const;             
@@ -111,7 +116,7 @@ public:
     bool empty() const { return data_count == 0; }                        
     void print_tree(int level = 0, std::ostream &outs = std::cout) const;
     bool is_valid(); 
-    friend std::ostream& operator<<(std::ostream& outs, const BTree<Item>& print_me)
+    friend std::ostream& operator<<(std::ostream& outs, const BTree<Item, Alloc>& print_me)
     {
         print_me.print_tree(0, outs);
         return outs;
@@ -123,14 +128,21 @@ private:
     static const int MINIMUM = 1;
     static const int MAXIMUM = 2 * MINIMUM;
 
+    typedef Alloc<BTree<Item, Alloc> > Pool;
+
     // PRIVATE MEMBER VARIABLES
     bool dups_ok;                                   
     int data_count;                               
     Item data[MAXIMUM + 1];                         
     int child_count;                               
     BTree* subset[MAXIMUM + 2];                    
+    Pool* pool;
+    bool owns_pool;
 
     // PRIVATE MEMBER FUNCTIONS
+    BTree(bool dups, Pool* shared);
+    BTree<Item, Alloc>* new_node();
+    void delete_node(BTree<Item, Alloc>* node);
     bool is_leaf() const { return child_count == 0; }   
     void loose_insert(const Item& entry);             
     void fix_excess(int i);                        
@@ -144,34 +156,52 @@ private:
 };
 
 // CONSTRUCTORS
-template<typename Item>
-BTree<Item>::BTree(bool dupes)
+template<typename Item, template <class> class Alloc>
+BTree<Item, Alloc>::BTree(bool dupes)
 {
     data_count = 0;
     child_count = 0;
     dups_ok = dupes;
+    pool = NULL;
+    owns_pool = true;
 }
 
-template<typename Item>
-BTree<Item>::BTree(const BTree<Item>& other)
+// A node under the root, which shares the root's pool
+template<typename Item, template <class> class Alloc>
+BTree<Item, Alloc>::BTree(bool dupes, Pool* shared)
+{
+    data_count = 0;
+    child_count = 0;
+    dups_ok = dupes;
+    pool = shared;
+    owns_pool = false;
+}
+
+template<typename Item, template <class> class Alloc>
+BTree<Item, Alloc>::BTree(const BTree<Item, Alloc>& other)
 {
     this->dups_ok = other.dups_ok;
     data_count = 0;
     child_count = 0;
+    pool = NULL;
+    owns_pool = true;
     
     this->copy_tree(other);
 }
 
 // DESTRUCTOR
-template<typename Item>
-BTree<Item>::~BTree()
+template<typename Item, template <class> class Alloc>
+BTree<Item, Alloc>::~BTree()
 {
     this->clear_tree();
+
+    if (owns_pool)
+        delete pool;
 }
 
 // ASSIGNEMENT
-template<typename Item>
-BTree<Item>& BTree<Item>::operator=(const BTree<Item>& rhs)
+template<typename Item, template <class> class Alloc>
+BTree<Item, Alloc>& BTree<Item, Alloc>::operator=(const BTree<Item, Alloc>& rhs)
 {
     this->clear_tree();
     this->copy_tree(rhs);
@@ -179,20 +209,20 @@ BTree<Item>& BTree<Item>::operator=(const BTree<Item>& rhs)
 }
 
 // MUTATORS
-template<typename Item>
-void BTree<Item>::insert(const Item& entry)
+template<typename Item, template <class> class Alloc>
+void BTree<Item, Alloc>::insert(const Item& entry)
 {
     loose_insert(entry);
 
     if (data_count > MAXIMUM)
     {
-        BTree<Item>* new_child;
-        new_child = new BTree<Item>(dups_ok);
+        BTree<Item, Alloc>* new_child;
+        new_child = new_node();
 
-        // Copy data into new child
-        copy_array(new_child->data, data, new_child->data_count, data_count);
-        // Copy subset into new child
-        copy_array(new_child->subset, subset, new_child->child_count, child_count);
+        // Move data into new child
+        move_array(new_child->data, data, new_child->data_count, data_count);
+        // Move subset into new child
+        move_array(new_child->subset, subset, new_child->child_count, child_count);
 
         data_count = 0;
         child_count = 1;
@@ -203,23 +233,23 @@ void BTree<Item>::insert(const Item& entry)
     }
 }
 
-template<typename Item>
-bool BTree<Item>::remove(const Item& entry)
+template<typename Item, template <class> class Alloc>
+bool BTree<Item, Alloc>::remove(const Item& entry)
 {
     if (!loose_remove(entry))
         return false;
     
     if (data_count == 0 && child_count == 1)
     {
-        BTree<Item>* temp;
+        BTree<Item, Alloc>* temp;
         temp = this->subset[0];
 
-        copy_array(this->data,
+        move_array(this->data,
                    temp->data,
                    this->data_count,
                    temp->data_count);
 
-        copy_array(this->subset,
+        move_array(this->subset,
                    temp->subset,
                    this->child_count,
                    temp->child_count);
@@ -229,19 +259,21 @@ bool BTree<Item>::remove(const Item& entry)
 
         temp->child_count = temp->data_count = 0;
 
-        delete temp;        
+        delete_node(temp);        
     }
     return true;
 }
 
-template<typename Item>
-void BTree<Item>::clear_tree()
+template<typename Item, template <class> class Alloc>
+void BTree<Item, Alloc>::clear_tree()
 {
     for (int i = 0; i < child_count; i++)
-    {
-        subset[i]->clear_tree();
-        delete subset[i];
-    }
+        delete_node(subset[i]);
+
+    // Every node is gone so the root
+    // frees their slabs all at once
+    if (owns_pool && pool != NULL)
+        pool->release();
 
     // Clears the data for the root, redundantly applied to
     // the dynamic nodes which are about to be deleted.
@@ -252,8 +284,8 @@ void BTree<Item>::clear_tree()
 }
 
 
-template<typename Item>
-void BTree<Item>::copy_tree(const BTree<Item>& other)
+template<typename Item, template <class> class Alloc>
+void BTree<Item, Alloc>::copy_tree(const BTree<Item, Alloc>& other)
 {
     this->clear_tree();
     copy_array(this->data, other.data, this->data_count, other.data_count);
@@ -261,20 +293,37 @@ void BTree<Item>::copy_tree(const BTree<Item>& other)
 
     for (int i = 0; i < other.child_count; i++)
     {
-        subset[i] = new BTree(dups_ok);
+        subset[i] = new_node();
         subset[i]->copy_tree(*other.subset[i]);
     }
 }
 
+template<typename Item, template <class> class Alloc>
+BTree<Item, Alloc>* BTree<Item, Alloc>::new_node()
+{
+    // Only the root is without a pool, until its first split
+    if (pool == NULL)
+        pool = new Pool;
+
+    return new (pool->allocate()) BTree<Item, Alloc>(dups_ok, pool);
+}
+
+template<typename Item, template <class> class Alloc>
+void BTree<Item, Alloc>::delete_node(BTree<Item, Alloc>* node)
+{
+    node->~BTree();
+    pool->deallocate(node);
+}
+
 // ACCESSORS
 
-template<typename Item>
-bool BTree<Item>::contains(const Item& target) const
+template<typename Item, template <class> class Alloc>
+bool BTree<Item, Alloc>::contains(const Item& target) const
 {
     int index;
     index = first_ge(data, data_count, target);
 
-    if (data[index] == target)
+    if (index < data_count && data[index] == target)
         return true;
     else if (!is_leaf())
         return subset[index]->contains(target);
@@ -282,8 +331,8 @@ bool BTree<Item>::contains(const Item& target) const
         return false;
 }
 
-template<typename Item>
-Item* BTree<Item>::find(const Item& target)
+template<typename Item, template <class> class Alloc>
+Item* BTree<Item, Alloc>::find(const Item& target)
 {
     assert(this->contains(target));
 
@@ -293,8 +342,8 @@ Item* BTree<Item>::find(const Item& target)
     return ptr;
 }
 
-template<typename Item>
-int BTree<Item>::size() const
+template<typename Item, template <class> class Alloc>
+int BTree<Item, Alloc>::size() const
 {
     int size;
     size = data_count;
@@ -305,13 +354,13 @@ int BTree<Item>::size() const
     return size;
 }
 
-template<typename Item>
-Item& BTree<Item>::get(const Item& target)
+template<typename Item, template <class> class Alloc>
+Item& BTree<Item, Alloc>::get(const Item& target)
 {
     int index;
     index = first_ge(data, data_count, target);
 
-    if (data[index] == target)
+    if (index < data_count && data[index] == target)
         return data[index];
     else if (!is_leaf())
         return subset[index]->get(target);
@@ -319,8 +368,8 @@ Item& BTree<Item>::get(const Item& target)
         std::cout << "Item is not in tree." << std::endl;
 }
 
-template<typename Item>
-void BTree<Item>::print_tree(int level, std::ostream& outs) const
+template<typename Item, template <class> class Alloc>
+void BTree<Item, Alloc>::print_tree(int level, std::ostream& outs) const
 {
     if (!is_leaf())
     {
@@ -344,8 +393,8 @@ void BTree<Item>::print_tree(int level, std::ostream& outs) const
 
 // PRIVATE HELPER FUNCTIONS
 
-template<typename Item>
-bool BTree<Item>::loose_remove(const Item& target)
+template<typename Item, template <class> class Alloc>
+bool BTree<Item, Alloc>::loose_remove(const Item& target)
 {
     Item hold;
     int index;
@@ -383,8 +432,8 @@ bool BTree<Item>::loose_remove(const Item& target)
         std::cout << "Something went wrong in loose_remove()" << std::endl;   
 }
 
-template<typename Item>
-void BTree<Item>::remove_biggest(Item& removed_entry)
+template<typename Item, template <class> class Alloc>
+void BTree<Item, Alloc>::remove_biggest(Item& removed_entry)
 {
     if (child_count == 0)
     {
@@ -399,8 +448,8 @@ void BTree<Item>::remove_biggest(Item& removed_entry)
     }
 }
 
-template<typename Item>
-void BTree<Item>::fix_shortage(int i)
+template<typename Item, template <class> class Alloc>
+void BTree<Item, Alloc>::fix_shortage(int i)
 {
     Item hold;
     BTree* tree_hold;
@@ -472,7 +521,7 @@ void BTree<Item>::fix_shortage(int i)
               subset[i]->child_count);
 
         delete_item(subset, i, child_count, tree_hold);
-        delete tree_hold;
+        delete_node(tree_hold);
     }
     // Case 4: Combine subset[i] with subset[i + 1]
     else if (i + 1 < child_count && subset[i + 1]->data_count == MINIMUM)
@@ -492,7 +541,7 @@ void BTree<Item>::fix_shortage(int i)
               subset[i + 1]->child_count);
 
         delete_item(subset, i + 1, child_count, tree_hold);
-        delete tree_hold;
+        delete_node(tree_hold);
     }
     else
     {
@@ -500,14 +549,14 @@ void BTree<Item>::fix_shortage(int i)
     }
 }
 
-template<typename Item>
-void BTree<Item>::fix_excess(int index)
+template<typename Item, template <class> class Alloc>
+void BTree<Item, Alloc>::fix_excess(int index)
 {
     Item mid;
     mid = subset[index]->data[(MAXIMUM + 1) / 2];
 
-    BTree<Item>* new_child;
-    new_child = new BTree<Item>(dups_ok);
+    BTree<Item, Alloc>* new_child;
+    new_child = new_node();
 
     // Split the data array between the 2 children
     split(subset[index]->data,
@@ -528,13 +577,15 @@ void BTree<Item>::fix_excess(int index)
     insert_item(data, index, data_count, mid);
 }
 
-template<typename Item>
-void BTree<Item>::loose_insert(const Item& entry)
+template<typename Item, template <class> class Alloc>
+void BTree<Item, Alloc>::loose_insert(const Item& entry)
 {
     int i;
     i = first_ge(data, data_count, entry);
 
-    if (data[i] == entry)
+    // data[data_count] may still hold an item moved out by
+    // fix_excess, so it is never compared
+    if (i < data_count && data[i] == entry)
         data[i] = entry;      
     else if (this->is_leaf())
         insert_item(data, i, data_count, entry);    
@@ -546,8 +597,8 @@ void BTree<Item>::loose_insert(const Item& entry)
     }
 }
 
-template<typename Item>
-bool BTree<Item>::is_valid()
+template<typename Item, template <class> class Alloc>
+bool BTree<Item, Alloc>::is_valid()
 {
     bool valid;
     valid = true;
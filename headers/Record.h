@@ -1,12 +1,12 @@
 /*********************************************************
  *   AUTHOR        : Jordan Miller
- * 
+ *
  *   PROJECT       : Relational Database
- * 
+ *
  *   PURPOSE       : Relatinal database management system
  *                   using B+ Tree indexing with SQL command
  *                   interface
- * 
+ *
  *   Copyright (c) 2019, Jordan Miller
  ********************************************************
  The Record class takes as input a vector of fields
@@ -15,7 +15,40 @@
  It is also able to read from a binary file and
  return a vector where each element is an item
  in that record.
- 
+
+ Records are variable length.  The fields are packed
+ one after another behind a small directory of where
+ each field ends:
+
+    [field count : 2 bytes][field ends : 2 bytes each][fields]
+
+ and the packed record is stored in a slot of a Page
+ (see page.h).  read() and write() use record ids made
+ of a page number and a slot rather than fixed offsets,
+ and go through the BufferPool (see buffer_pool.h) rather
+ than reading the file directly.
+
+ redo() writes a record back at the record id it was
+ given when it was first written, replacing whatever is in
+ that slot.  It's used to replay a table's write-ahead log
+ (see wal.h).
+
+ reuse() writes a record into the slot of a deleted record
+ in a given page rather than at the end of the table.
+
+ rewrite() writes a record over the one at a record id so
+ the record keeps its id.  It fails if the record no longer
+ fits in its page.
+
+ A Record read from a Page with read(page, slot) isn't
+ copied out of the page.  It uses the page's bytes, so it
+ can only be used while the page is.
+
+ get_field() gives the bytes of one field where they are
+ in the record rather than copying every field into a
+ string like get_fields() does.  A select of a few fields
+ of a wide record only looks at the fields it needs.
+
  */
 
 #ifndef RECORD_H
@@ -26,7 +59,10 @@
 #include <cstdlib>
 #include <string>
 #include <cstring>
+#include <stdint.h>
 #include "./vector.h"
+#include "./page.h"
+#include "./buffer_pool.h"
 
 typedef jmiller::Vector<std::string> Vectorstr;
 
@@ -36,69 +72,303 @@ public:
     // CONSTRUCTORS
     Record();
     Record(Vectorstr entry);
+    Record(const Record& other);
+
+    // ASSIGNMENT OPERATOR
+    Record& operator =(const Record& rhs);
+
+    // ACCESSORS
+    bool valid() const { return rec_size > 0; }
+    const char* data() const { return rec_view; }
+    int size() const { return rec_size; }
+    int field_count() const { return rec_size == 0 ? 0 : get_u16(0); }
+    bool get_field(int field, const char*& data, int& length) const;
 
     // FILE FUNCTIONS
     Vectorstr get_fields();
-    long write(std::fstream& outs);
-    long read(std::fstream& ins, long recno);
+    long write(BufferPool& pool, int file);
+    long reuse(BufferPool& pool, int file, long page_no);
+    long read(BufferPool& pool, int file, long recno);
+    bool redo(BufferPool& pool, int file, long recno);
+    bool rewrite(BufferPool& pool, int file, long recno);
+    bool read(const Page& page, int slot);
+    void set(const char* data, int length);
 
 private:
-    static const int ROW_MAX = 10;
-    static const int COL_MAX = 200;
-    char rec_data[ROW_MAX][COL_MAX];
+    char rec_data[Page::MAX_RECORD];
+
+    // The bytes of the record.  Either rec_data or
+    // the page the record was read from.
+    const char* rec_view;
+    int rec_size;
 
+    int get_u16(int pos) const;
+    void set_u16(int pos, int value);
 };
 
 Record::Record()
 {
-    for (int i = 0; i < ROW_MAX; i++)
-        rec_data[i][0] = '\0';
+    rec_view = rec_data;
+    rec_size = 0;
+}
+
+Record::Record(const Record& other)
+{
+    set(other.rec_view, other.rec_size);
+}
+
+Record& Record::operator =(const Record& rhs)
+{
+    if (this != &rhs)
+        set(rhs.rec_view, rhs.rec_size);
+
+    return *this;
 }
 
 Record::Record(Vectorstr entry)
 {
-    for (int i = 0; i < ROW_MAX; i++)
-        rec_data[i][0] = '\0';
-    
+    int pos;
+    int header_size;
+
+    rec_view = rec_data;
+
+    header_size = 2 + 2 * entry.size();
+    pos = header_size;
+
+    // Records which won't fit in a page are left empty
+    // so the caller can see they are not valid.
+    rec_size = 0;
+    for (int i = 0; i < entry.size(); i++)
+        pos += entry[i].size();
+
+    if (pos > Page::MAX_RECORD)
+        return;
+
+    set_u16(0, entry.size());
+    pos = header_size;
+
     for (int i = 0; i < entry.size(); i++)
-        strcpy(rec_data[i], entry[i].c_str());
+    {
+        memcpy(rec_data + pos, entry[i].data(), entry[i].size());
+        pos += entry[i].size();
+        set_u16(2 + 2 * i, pos);
+    }
+
+    rec_size = pos;
 }
 
 Vectorstr Record::get_fields()
 {
     Vectorstr fields;
+    int field_count;
+    int start;
+    int end;
+
+    if (rec_size == 0)
+        return fields;
 
-    for (int i = 0; i < ROW_MAX; i++)
-        if (rec_data[i][0] != '\0')
-            fields.push_back(std::string(rec_data[i]));
+    field_count = get_u16(0);
+    start = 2 + 2 * field_count;
+
+    for (int i = 0; i < field_count; i++)
+    {
+        end = get_u16(2 + 2 * i);
+        fields.push_back(std::string(rec_view + start, end - start));
+        start = end;
+    }
 
     return fields;
 }
 
-long Record::write(std::fstream& outs)
+bool Record::get_field(int field, const char*& data, int& length) const
+{
+    int start;
+    int end;
+
+    if (field < 0 || field >= field_count())
+        return false;
+
+    // A field starts where the one before it ends, and
+    // the first starts right after the field ends
+    if (field == 0)
+        start = 2 + 2 * field_count();
+    else
+        start = get_u16(2 + 2 * (field - 1));
+
+    end = get_u16(2 + 2 * field);
+
+    data = rec_view + start;
+    length = end - start;
+    return true;
+}
+
+long Record::write(BufferPool& pool, int file)
+{
+    Page* page;
+    long page_no;
+    int slot;
+
+    // Page 0 holds the table's field names so data
+    // pages start at page 1.  The record goes in the last
+    // page if there is room, otherwise a new page is started.
+    page = NULL;
+    page_no = pool.page_count(file) - 1;
+
+    if (page_no >= 1)
+    {
+        page = pool.fetch(file, page_no);
+
+        if (page != NULL && page->free_space() < rec_size + Page::SLOT_SIZE)
+        {
+            pool.unpin(file, page_no, false);
+            page = NULL;
+        }
+    }
+
+    if (page == NULL)
+        page = pool.new_page(file, page_no);
+
+    if (page == NULL)
+        return 0;
+
+    slot = page->insert(rec_view, rec_size);
+    pool.unpin(file, page_no, true);
+
+    return Page::rid(page_no, slot);
+}
+
+long Record::reuse(BufferPool& pool, int file, long page_no)
+{
+    Page* page;
+    int slot;
+
+    page = pool.fetch(file, page_no);
+
+    if (page == NULL)
+        return 0;
+
+    slot = page->reuse(rec_view, rec_size);
+    pool.unpin(file, page_no, slot >= 0);
+
+    if (slot < 0)
+        return 0;
+
+    return Page::rid(page_no, slot);
+}
+
+bool Record::redo(BufferPool& pool, int file, long recno)
+{
+    Page* page;
+    long page_no;
+    bool done;
+
+    page_no = Page::page_of(recno);
+
+    // The record replaces whatever its slot holds, since
+    // a slot can be reused after its record is deleted.
+    // A page the table doesn't have yet is the next one.
+    if (page_no < pool.page_count(file))
+        page = pool.fetch(file, page_no);
+    else
+        page = pool.new_page(file, page_no);
+
+    if (page == NULL)
+        return false;
+
+    done = page_no == Page::page_of(recno) &&
+           page->put(Page::slot_of(recno), rec_view, rec_size);
+
+    if (!done)
+        std::cout << "Log record " << recno << " could not be replayed." << std::endl;
+
+    pool.unpin(file, page_no, true);
+    return done;
+}
+
+bool Record::rewrite(BufferPool& pool, int file, long recno)
 {
-    outs.seekg(0, outs.end);
-    long pos = outs.tellp();
+    Page* page;
+    long page_no;
+    bool done;
+
+    page_no = Page::page_of(recno);
+
+    if (page_no < 1 || page_no >= pool.page_count(file))
+        return false;
 
-    outs.write(&rec_data[0][0], sizeof(rec_data));
+    page = pool.fetch(file, page_no);
 
-    return pos / sizeof(rec_data);
+    if (page == NULL)
+        return false;
+
+    done = page->replace(Page::slot_of(recno), rec_view, rec_size);
+    pool.unpin(file, page_no, done);
+
+    return done;
 }
 
-long Record::read(std::fstream& ins, long recno)
+long Record::read(BufferPool& pool, int file, long recno)
 {
-    long pos;
-    pos = recno * sizeof(rec_data);
+    const Page* page;
+    long page_no;
+    bool found;
+
+    page_no = Page::page_of(recno);
+    page = pool.read(file, page_no);
+    found = (page != NULL && read(*page, Page::slot_of(recno)));
+
+    // The record is copied out of the page since
+    // the page is given back to the pool
+    if (found)
+        set(rec_view, rec_size);
+
+    if (page != NULL)
+        pool.release(file, page_no, page);
 
-    ins.seekg(pos, std::ios_base::beg);
+    if (!found)
+    {
+        rec_view = rec_data;
+        rec_size = 0;
+        return 0;
+    }
 
-    ins.read(&rec_data[0][0], sizeof(rec_data));
+    return 1;
+}
+
+bool Record::read(const Page& page, int slot)
+{
+    const char* data;
+    int length;
 
-    return ins.gcount() / sizeof(rec_data);
+    if (!page.get(slot, data, length))
+        return false;
+
+    rec_view = data;
+    rec_size = length;
+    return true;
 }
 
+void Record::set(const char* data, int length)
+{
+    if (data != rec_data)
+        memcpy(rec_data, data, length);
 
+    rec_view = rec_data;
+    rec_size = length;
+}
 
+int Record::get_u16(int pos) const
+{
+    uint16_t value;
+    memcpy(&value, rec_view + pos, sizeof(value));
+    return value;
+}
 
+void Record::set_u16(int pos, int value)
+{
+    uint16_t v;
+    v = value;
+    memcpy(rec_data + pos, &v, sizeof(v));
+}
 
-#endif
\ No newline at end of file
+#endif
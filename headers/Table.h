@@ -18,336 +18,2456 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
-#include "./BTree.h"
+#include <algorithm>
+#include <utility>
 #include "./Record.h"
+#include "./value.h"
+#include "./index_file.h"
+#include "./column_file.h"
+#include "./tombstones.h"
+#include "./dictionary.h"
+#include "./catalog.h"
+#include "./wal.h"
 #include "./map.h"
 #include "./mmap.h"
+#include "./row_set.h"
+#include "./column_index.h"
 #include "./stack.h"
 
-typedef Map<std::string, MMap<std::string, std::size_t> > mmap_map;
-typedef MMap<std::string, size_t>::Iterator mmap_iter;
-
-bool file_exists(const std::string file);
+typedef Map<std::string, ColumnIndex> index_map;
+typedef ColumnIndex::Iterator index_iter;
 
 class Table
 {
 public:
+    // A select's result.  The records which meet the
+    // conditions are read from the table one at a time as
+    // the cursor is moved along rather than being copied
+    // into a table of their own, so a select of every record
+    // only holds one record at a time.  A cursor refers to
+    // its table and can't outlive it.
+    class Cursor
+    {
+    public:
+        // ACCESSORS
+        std::size_t size() const { return count; }
+        const Vectorstr& names() const { return field_names; }
+        const Vectorstr& fields() const { return row; }
+
+        // MUTATORS
+        bool next();
+
+        // PRINT FUNCTION
+        // The records are printed as the cursor moves
+        // over them, so a cursor can only be printed once
+        friend std::ostream& operator<<(std::ostream& outs, Cursor& print_me)
+        {
+            int counter;
+            counter = 1;
+
+            outs << "\n\nTable name: " << print_me.table_name
+                 << ", records: " << print_me.count << std::endl << std::endl;
+
+            outs << std::setw(11) << std::left << "  Record ";
+
+            for (int i = 0; i < print_me.field_names.size(); i++)
+                outs << std::setw(16) << std::left << print_me.field_names[i];
+
+            outs << "\n  -------------------------------------------------------------------------------------"
+                 << std::endl;
+
+            outs << std::endl;
+
+            while (print_me.next())
+            {
+                outs << std::setw(7) << std::right << counter++ << std::setw(4) << std::left << ".";
+
+                for (int i = 0; i < print_me.row.size(); i++)
+                    outs << std::setw(16) << std::left << print_me.row[i];
+
+                outs << std::endl;
+            }
+
+            outs << "\n\n" << std::endl;
+            return outs;
+        }
+
+    private:
+        friend class Table;
+
+        const Table* table;
+        std::string table_name;
+        Vectorstr field_names;
+        jmiller::Vector<std::size_t> cols;
+        jmiller::Vector<std::size_t> recnos;
+        bool scanning;
+        std::size_t position;
+        long page_no;
+        long page_count;
+        long read_ahead;
+        int slot;
+        int slot_count;
+        std::size_t count;
+        Vectorstr row;
+
+        void read_ahead_of(long page_no);
+
+        // CONSTRUCTORS
+        Cursor(const Table* table, const Vectorstr& names,
+               const jmiller::Vector<std::size_t>& cols,
+               const jmiller::Vector<std::size_t>& recnos, bool scan);
+    };
+
     // CONSTRUCTORS
-    Table(const std::string& name, const Vectorstr fields);
+    Table(const std::string& name, const Vectorstr& fields,
+          const Vectorstr& types = Vectorstr(), bool by_column = false);
     Table(const std::string& name);
+    Table(Table&& other) = default;
+
+    // DESTRUCTOR
+    ~Table();
+
+    // MUTATORS
+    std::size_t insert_into(const Vectorstr& values);
+    std::size_t load(const std::string& source);
+    std::size_t delete_from(const Vectorstr& conditions);
+    std::size_t update(const Vectorstr& fields, const Vectorstr& values,
+                       const Vectorstr& conditions);
+    void compact();
+    bool create_index(const std::string& field, const std::string& kind);
+    bool drop_index(const std::string& field);
+    Cursor select(const Vectorstr& columns, const Vectorstr& rows);
+    Table select_all();
+
+    // SCHEMA
+    static bool valid_types(const Vectorstr& types);
+
+    // CATALOG
+    static void open_catalog();
+
+    // BUFFER POOL
+    static void flush() { buffer_pool.flush_all(); }
+    static void set_mapped_reads(bool on) { buffer_pool.set_mapped_reads(on); }
+
+    // WRITE-AHEAD LOG
+    static void commit();
+    static void sync();
+    static void set_commit_policy(CommitPolicy policy,
+                                  long group_bytes = LogManager::GROUP_BYTES,
+                                  long group_ms = LogManager::GROUP_MS)
+    {
+        log_manager.set_policy(policy, group_bytes, group_ms);
+    }
+
+    // PRINT FUNCTION
+    friend std::ostream& operator<<(std::ostream& outs,
+                                    const Table& print_me)
+    {
+        Value value;
+        jmiller::Vector<Value> values;
+        Record reader;
+        const Page* page;
+        const char* data;
+        int length;
+        long page_count;
+        std::size_t rows;
+        int counter;
+        counter = 1;
+
+        std::cout << "\n\nTable name: " << print_me.table_name 
+                  << ", records: " << print_me.record_number << std::endl << std::endl;
+
+        std::cout << std::setw(11) << std::left << "  Record ";
+
+        for (int i = 0; i < print_me.field_names.size(); i++)
+            std::cout << std::setw(16) << std::left << print_me.field_names[i];
+
+        std::cout <<  "\n  -------------------------------------------------------------------------------------"
+                  << std::endl;
+
+        std::cout << std::endl;
+        page_count = (print_me.file_id < 0 || print_me.columnar) ? 0 : buffer_pool.page_count(print_me.file_id);
+        rows = print_me.columnar ? print_me.column_rows() : 0;
+
+        // A columnar table is printed a row at a time
+        // with each value read from its own column.
+        // Deleted rows have no values.
+        for (std::size_t row = 1; row <= rows; row++)
+        {
+            values = print_me.read_values(row);
+
+            if (values.size() == 0)
+                continue;
+
+            std::cout << std::setw(7) << std::right << counter++ << std::setw(4) << std::left << ".";
+
+            for (int i = 0; i < values.size(); i++)
+                std::cout << std::setw(16) << std::left << print_me.value_text(i, values[i]);
+
+            std::cout << std::endl;
+        }
+
+        // Reads the table a page at a time and prints
+        // every record in each page
+        for (long page_no = 1; page_no < page_count; page_no++)
+        {
+            page = buffer_pool.read(print_me.file_id, page_no);
+
+            for (int slot = 0; slot < page->slot_count(); slot++)
+            {
+                if (!reader.read(*page, slot))
+                    continue;
+
+                std::cout << std::setw(7) << std::right << counter++ << std::setw(4) << std::left << ".";
+
+                for (int i = 0; i < reader.field_count(); i++)
+                {
+                    reader.get_field(i, data, length);
+                    value = Value::decode(print_me.field_types[i], data, length);
+                    std::cout << std::setw(16) << std::left << print_me.value_text(i, value);
+                }
+
+                std::cout << std::endl;
+            }
+
+            buffer_pool.release(print_me.file_id, page_no, page);
+        }
+
+        std::cout << "\n\n" << std::endl;
+        return outs;
+    }
+    
+ private:
+    // STATIC MEMBER CONSTANTS
+    static const int LOAD_BATCH_PAGES = 64;
+
+    // A value of a field and the record it's in,
+    // sorted by value to build an index
+    struct KeyRid
+    {
+        Value key;
+        std::size_t rid;
+
+        KeyRid(const Value& k = Value(), std::size_t r = 0) : key(k), rid(r) {}
+
+        friend bool operator <(const KeyRid& lhs, const KeyRid& rhs)
+        {
+            return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.rid < rhs.rid);
+        }
+
+        // Picked over the swap in array_functions.h by std::sort
+        friend void swap(KeyRid& lhs, KeyRid& rhs)
+        {
+            std::swap(lhs.key, rhs.key);
+            std::swap(lhs.rid, rhs.rid);
+        }
+    };
+
+    // Entries for an index file which are written to it
+    // once the log records of their statement are on disk.
+    // Entries which extend the file are every record after
+    // the one numbered after, up to last.
+    struct IndexEntries
+    {
+        std::string table_file;
+        std::string index_file;
+        FieldType type;
+        bool removed;
+        bool extends;
+        std::size_t after;
+        std::size_t last;
+        jmiller::Vector<MPair<Value, std::size_t> > entries;
+    };
+
+    static std::size_t serial;
+    static jmiller::Vector<IndexEntries> pending_entries;
+    static Map<std::string, ColumnIndex> kept_indices;
+    static BufferPool buffer_pool;
+    static LogManager log_manager;
+    static Catalog catalog;
+    Map<std::string, int> precedence;
+    std::string table_name;
+    std::string file_name;
+    int file_id;
+    WriteAheadLog* log;
+    index_map indices;
+    Vectorstr field_names;
+    jmiller::Vector<FieldType> field_types;
+    Map<std::string, std::size_t> field_indices;
+    Map<std::string, bool> index_loaded;
+    jmiller::Vector<ColumnFile> columns;
+    Tombstones tombstones;
+    jmiller::Vector<Dictionary*> dictionaries;
+    bool columnar;
+    bool empty;
+    std::size_t record_number;
+    TableInfo* info;
+
+    void set_prec();
+    void set_fields(const Vectorstr& field_names, const Vectorstr& types);
+    std::string index_file_name(const std::string& field);
+    std::string log_file_name();
+    std::string column_file_name(const std::string& field);
+    std::string dictionary_file_name(const std::string& field);
+    std::string tombstone_file_name();
+    void open_columns(bool create);
+    void open_dictionaries(bool create);
+    bool parse_value(int col, const std::string& text, Value& value);
+    std::string value_text(int col, const Value& value) const;
+    std::size_t append_columns(const Vectorstr& values, std::size_t row);
+    void truncate_columns(std::size_t rows);
+    std::size_t column_rows() const;
+    std::size_t last_rid() const;
+    std::size_t place_record(Record& record, const Vectorstr& encoded, bool& reused);
+    std::size_t rewrite_record(std::size_t recno, const jmiller::Vector<Value>& row,
+                               const jmiller::Vector<bool>& changed);
+    bool erase_record(std::size_t recno);
+    void add_free_page(long page_no);
+    jmiller::Vector<std::size_t> index_coverage();
+    void log_index_entries(std::size_t rid, const jmiller::Vector<Value>& row,
+                           const jmiller::Vector<std::size_t>& covered);
+    void queue_index_entries(const jmiller::Vector<jmiller::Vector<KeyRid> >& postings,
+                             bool removed, const jmiller::Vector<std::size_t>& covered);
+    void queue_index_entry(std::size_t col, bool removed, const Value& key, std::size_t rid);
+    void queue_new_entry(std::size_t col, const Value& key, std::size_t rid, std::size_t after);
+    void requeue_index_entries(const jmiller::Vector<jmiller::Vector<KeyRid> >& keys);
+    static void write_index_entries(const std::string& table_file);
+    void recover();
+    void take_indices();
+    void load_index(const std::string& field);
+    bool has_index(std::size_t col) const;
+    void widen_range(int col, const Value& value);
+    static uint64_t checkpointed(const std::string& table_file);
+    jmiller::Vector<std::size_t> all_recnos(std::size_t after = 0) const;
+    Vectorstr read_fields(std::size_t recno,
+                          const jmiller::Vector<std::size_t>& cols) const;
+    jmiller::Vector<Value> read_values(std::size_t recno) const;
+    jmiller::Vector<Value> read_values(std::size_t recno,
+                                       const jmiller::Vector<std::size_t>& cols) const;
+    RowSet get_conditional_indices(const Vectorstr& conditions);
+    RowSet get_simple_indices(Vectorstr& s_conditions);
+    RowSet get_dictionary_indices(Vectorstr& s_conditions);
+    static void add_postings(const ColumnIndex& index, const RowSet& postings,
+                             RowSet& rows, jmiller::Vector<std::size_t>& recnos);
+    RowSet scan_condition(std::size_t col, const Value& key, const std::string& op);
+    static bool meets(const Value& value, const std::string& op, const Value& key);
+    Vectorstr get_rpn(Vectorstr conditions);
+    static Vectorstr split_line(const std::string& line, char delimiter);
+};
+
+jmiller::Vector<Table::IndexEntries> Table::pending_entries;
+Map<std::string, ColumnIndex> Table::kept_indices;
+BufferPool Table::buffer_pool;
+LogManager Table::log_manager(Table::buffer_pool);
+Catalog Table::catalog;
+
+Table::Table(const std::string& name, const Vectorstr& fields, const Vectorstr& types,
+             bool by_column)
+{
+    Vectorstr type_names;
+    std::string storage;
+    ColumnInfo column;
+
+    // The catalog is loaded once by open_catalog() before
+    // any table is opened, not by each table
+    assert(catalog.loaded());
+
+    table_name = name;
+    file_name = ".\\bin\\" + name + ".tbl";
+    record_number = 0;
+    columnar = by_column;
+    storage = columnar ? "columnar" : "rows";
+    set_fields(fields, types);
+    open_dictionaries(true);
+
+    for (int i = 0; i < field_types.size(); i++)
+        type_names.push_back(field_types[i].name());
+
+    // The table replaces any table of the same name in
+    // the catalog, which is saved at the checkpoint below
+    info = new TableInfo;
+    info->name = table_name;
+    info->table_file = file_name;
+    info->columnar = columnar;
+
+    for (int i = 0; i < field_names.size(); i++)
+    {
+        column.name = field_names[i];
+        column.type = type_names[i];
+        column.index_file = ".\\bin\\" + name + "_" + field_names[i] + ".idx";
+
+        // A new table's fields have no index until one
+        // is made for them by create_index()
+        column.index_kind = "none";
+        info->columns.push_back(column);
+    }
+
+    catalog.add(info);
+
+    // The indices kept from a table this one replaces
+    // don't describe it
+    for (int i = 0; i < field_names.size(); i++)
+        if (kept_indices.contains(index_file_name(field_names[i])))
+            kept_indices.erase(index_file_name(field_names[i]));
+
+    Record field_record(fields);
+    Record type_record(type_names);
+    Page* header;
+    long page_no;
+    uint64_t count;
+    count = 0;
+
+    // Creates the file, or empties it if it already exists,
+    // and opens it for read / write through the buffer pool
+    file_id = buffer_pool.open_file(file_name, true);
+    log = log_manager.create(log_file_name(), file_name);
+
+    // Page 0 is the header page.  Slot 0 holds the field
+    // names, slot 2 holds the type of each field and slot 3
+    // says if the records are stored in rows or by column.
+    // The number of records in slot 1 is only kept up to
+    // date by tables made before the catalog.
+    header = buffer_pool.new_page(file_id, page_no);
+    header->insert(field_record.data(), field_record.size());
+    header->insert((const char*)&count, sizeof(count));
+    header->insert(type_record.data(), type_record.size());
+    header->insert(storage.data(), storage.size());
+    buffer_pool.unpin(file_id, page_no, true);
+
+    // A columnar table keeps the header page in the table
+    // file and the values of each field in a file of its own
+    if (columnar)
+        open_columns(true);
+
+    // The header page isn't logged so it's
+    // forced to disk before any record is
+    log_manager.checkpoint(log);
+}
+
+Table::Table(const std::string& name)
+{
+    Vectorstr values;
+    Vectorstr types;
+    Record fields_record;
+    Record types_record;
+    const Page* header;
+    const char* storage;
+    int length;
+    jmiller::Vector<std::size_t> recnos;
+    jmiller::Vector<Value> row;
+    ColumnInfo column;
+
+    assert(catalog.loaded());
+
+    table_name = name;
+    file_name = ".\\bin\\" + name + ".tbl";
+    record_number = 0;
+    columnar = false;
+    log = NULL;
+    info = catalog.find(name);
+
+    file_id = buffer_pool.open_file(file_name);
+
+    if (info != NULL && info->version > TableInfo::LAYOUT_VERSION)
+    {
+        std::cout << name << " was made by a newer version." << std::endl;
+        file_id = -1;
+    }
+
+    if (file_id < 0)
+    {
+        std::cout << file_name << " does not exist." << std::endl;
+        info = NULL;
+    }
+    else if (info != NULL)
+    {
+        // Everything needed to open the table is in the
+        // catalog, so none of its files are read here
+        for (int i = 0; i < info->columns.size(); i++)
+        {
+            values.push_back(info->columns[i].name);
+            types.push_back(info->columns[i].type);
+        }
+
+        set_fields(values, types);
+        open_dictionaries(false);
+        columnar = info->columnar;
+        record_number = info->records;
+        recover();
+    }
+    else
+    {
+        // A table made before the catalog is described by
+        // its header page and added to the catalog
+        info = new TableInfo;
+        info->name = table_name;
+        info->table_file = file_name;
+        info->version = 1;
+
+        header = buffer_pool.read(file_id, 0);
+
+        if (header != NULL)
+        {
+            fields_record.read(*header, 0);
+            values = fields_record.get_fields();
+
+            // Tables made before fields had types have no
+            // types slot and every field is a varchar
+            if (types_record.read(*header, 2))
+            {
+                types = types_record.get_fields();
+                info->version = 2;
+            }
+
+            // Tables made before columnar storage have no
+            // storage slot and are stored in rows
+            if (header->get(3, storage, length))
+            {
+                columnar = std::string(storage, length) == "columnar";
+                info->version = 3;
+            }
+
+            buffer_pool.release(file_id, 0, header);
+        }
+
+        set_fields(values, types);
+        open_dictionaries(false);
+        info->columnar = columnar;
+
+        for (int i = 0; i < field_names.size(); i++)
+        {
+            column.name = field_names[i];
+            column.type = field_types[i].name();
+            column.index_file = ".\\bin\\" + name + "_" + field_names[i] + ".idx";
+            info->columns.push_back(column);
+        }
+
+        recover();
+
+        // The records are counted, and the range of each
+        // field found, by reading the table this once
+        recnos = all_recnos();
+        record_number = recnos.size();
+
+        for (int i = 0; i < recnos.size(); i++)
+        {
+            row = read_values(recnos[i]);
+
+            for (int j = 0; j < row.size(); j++)
+                widen_range(j, row[j]);
+        }
+
+        info->records = record_number;
+        catalog.add(info);
+        log_manager.checkpoint(log);
+    }
+
+    // The indices are not built here.  Each one is loaded
+    // from its index file by load_index() the first time a
+    // condition on its field needs it, unless an earlier
+    // statement on the table already loaded it.
+    if (info != NULL)
+        take_indices();
+}
+
+Table::~Table()
+{
+    // The loaded indices are kept for the next statement
+    // on the table, so it doesn't read them again
+    for (int i = 0; i < field_names.size(); i++)
+        if (index_loaded[field_names[i]] && has_index(i))
+            kept_indices[index_file_name(field_names[i])] = std::move(indices[field_names[i]]);
+}
+
+std::size_t Table::insert_into(const Vectorstr& values)
+{
+    jmiller::Vector<Value> typed_values;
+    Vectorstr encoded;
+    Value value;
+    std::size_t recno;
+    jmiller::Vector<jmiller::Vector<KeyRid> > postings;
+    jmiller::Vector<std::size_t> covered;
+    std::size_t after;
+    bool indexed;
+    bool reused;
+
+    if (values.size() != field_names.size())
+    {
+        std::cout << "Expected " << field_names.size() << " values." << std::endl;
+        return 0;
+    }
+
+    // Each value is read as its field's type and
+    // stored in that type's binary form
+    for (int i = 0; i < values.size(); i++)
+    {
+        if (!parse_value(i, values[i], value))
+        {
+            std::cout << "\"" << values[i] << "\" is not a valid "
+                      << field_types[i].name() << " for " << field_names[i] << "." << std::endl;
+            return 0;
+        }
+
+        typed_values.push_back(value);
+        encoded.push_back(value.encode(field_types[i]));
+    }
+
+    Record new_record(encoded);
+
+    if (!new_record.valid())
+    {
+        std::cout << "Record is too large to fit in a page." << std::endl;
+        return 0;
+    }
+
+    // The last record before this one, which an index file
+    // has to cover for the new record to be appended to it
+    indexed = false;
+    after = 0;
+
+    for (int i = 0; i < field_names.size(); i++)
+        indexed = indexed || has_index(i);
+
+    if (indexed)
+        after = last_rid();
+
+    // Write the record and store its record id in recno.
+    // The record is still built for a columnar table since
+    // it's logged whole.
+    recno = place_record(new_record, encoded, reused);
+
+    if (recno == 0)
+        return 0;
+
+    record_number++;
+
+    // The catalog is changed in memory and saved when
+    // the table is next checkpointed
+    info->records = record_number;
+
+    for (int i = 0; i < typed_values.size(); i++)
+        widen_range(i, typed_values[i]);
+
+    // The record is logged rather than written to the table
+    // file.  The page stays in the buffer pool until the log
+    // is checkpointed and the log is forced to disk by
+    // commit() according to the commit policy.
+    log->append(WriteAheadLog::INSERT, recno, new_record.data(), new_record.size());
+
+    // If a field's index has already been loaded the recno
+    // is added to its set in memory
+    for (int i = 0; i < values.size(); i++)
+        if (index_loaded[field_names[i]])
+            indices[field_names[i]][typed_values[i]].add(recno);
+
+    // A new record at the end of the table is appended to
+    // the index files once its log record is on disk.  An
+    // index file which is behind the table is left for
+    // load_index() to bring up to date.
+    if (indexed && !reused)
+        for (int i = 0; i < typed_values.size(); i++)
+            if (has_index(i))
+                queue_new_entry(i, typed_values[i], recno, after);
+
+    // A reused slot comes before the end of the table, so
+    // the index files which already cover it are told once
+    // the statement is committed.  If the program stops
+    // first, recover() finds the keys in the INSERT record.
+    if (reused)
+    {
+        covered = index_coverage();
+
+        for (int i = 0; i < typed_values.size(); i++)
+        {
+            postings.emplace_back();
+            postings[i].push_back(KeyRid(typed_values[i], recno));
+        }
+
+        queue_index_entries(postings, false, covered);
+    }
+
+    return recno;
+}
+
+std::size_t Table::load(const std::string& source)
+{
+    std::ifstream ins;
+    std::string line;
+    Vectorstr values;
+    Vectorstr encoded;
+    jmiller::Vector<Value> typed_values;
+    Value value;
+    Page* batch;
+    int batch_count;
+    int slot;
+    long base_page;
+    long line_no;
+    char delimiter;
+    bool valid;
+    std::size_t loaded;
+    jmiller::Vector<jmiller::Vector<KeyRid> > postings;
+    jmiller::Vector<Pair<Value, RowSet> > merged;
+    std::size_t rid;
+    std::size_t first_row;
+
+    if (file_id < 0)
+        return 0;
+
+    ins.open(source.c_str());
+
+    if (ins.fail())
+    {
+        std::cout << "Couldn't open " << source << "." << std::endl;
+        return 0;
+    }
+
+    // TSV files are split on tabs and anything else on commas
+    delimiter = (source.size() > 4 && source.substr(source.size() - 4) == ".tsv") ? '\t' : ',';
+
+    // The indices are loaded before the table grows so that
+    // load_index() doesn't read the new records one at a time.
+    // Fields without an index are skipped by load_index().
+    for (int i = 0; i < field_names.size(); i++)
+    {
+        load_index(field_names[i]);
+        postings.emplace_back();
+    }
+
+    // The new pages are written straight to the table file
+    // rather than logged.  The table is checkpointed first
+    // so the log holds nothing but a LOAD record while they
+    // are written, and recovery counts the records again if
+    // the load didn't finish.
+    log_manager.checkpoint(log);
+    first_row = columnar ? column_rows() + 1 : 0;
+    log->append(WriteAheadLog::LOAD,
+                columnar ? first_row - 1 : buffer_pool.page_count(file_id), NULL, 0);
+    log->sync();
+
+    batch = new Page[LOAD_BATCH_PAGES];
+    batch_count = 1;
+    base_page = buffer_pool.page_count(file_id);
+    line_no = 0;
+    loaded = 0;
+
+    while (std::getline(ins, line))
+    {
+        line_no++;
+
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+
+        if (line.empty())
+            continue;
+
+        values = split_line(line, delimiter);
+
+        // A first line which names the fields is a header
+        if (line_no == 1 && values.size() == field_names.size())
+        {
+            valid = true;
+            for (int i = 0; i < values.size(); i++)
+                valid = valid && values[i] == field_names[i];
+
+            if (valid)
+                continue;
+        }
+
+        if (values.size() != field_names.size())
+        {
+            std::cout << "Line " << line_no << ": expected "
+                      << field_names.size() << " values." << std::endl;
+            continue;
+        }
+
+        // Reads each value as its field's type the same way
+        // insert_into() does.  Bad lines are skipped.
+        encoded.clear();
+        typed_values.clear();
+        valid = true;
+
+        for (int i = 0; i < values.size() && valid; i++)
+        {
+            valid = parse_value(i, values[i], value);
+
+            if (valid)
+            {
+                typed_values.push_back(value);
+                encoded.push_back(value.encode(field_types[i]));
+            }
+            else
+                std::cout << "Line " << line_no << ": \"" << values[i]
+                          << "\" is not a valid " << field_types[i].name()
+                          << " for " << field_names[i] << "." << std::endl;
+        }
+
+        if (!valid)
+            continue;
+
+        Record new_record(encoded);
+
+        if (!new_record.valid())
+        {
+            std::cout << "Line " << line_no << ": record is too large to fit in a page." << std::endl;
+            continue;
+        }
+
+        // A columnar table's values are added to the end of
+        // each column through the buffer pool instead
+        if (columnar)
+        {
+            rid = append_columns(encoded, first_row + loaded);
+
+            if (rid == 0)
+                continue;
+
+            loaded++;
+
+            for (int i = 0; i < typed_values.size(); i++)
+            {
+                if (has_index(i))
+                    postings[i].push_back(KeyRid(typed_values[i], rid));
+
+                widen_range(i, typed_values[i]);
+            }
+
+            continue;
+        }
+
+        // Fills the pages of the batch one after another and
+        // writes the whole batch once every page is used
+        slot = batch[batch_count - 1].insert(new_record.data(), new_record.size());
+
+        if (slot < 0)
+        {
+            if (batch_count == LOAD_BATCH_PAGES)
+            {
+                Dictionary::sync_all();
+                buffer_pool.append_pages(file_id, batch, batch_count);
+                base_page += batch_count;
+                batch_count = 0;
+            }
+
+            batch[batch_count] = Page();
+            batch_count++;
+            slot = batch[batch_count - 1].insert(new_record.data(), new_record.size());
+        }
+
+        rid = Page::rid(base_page + batch_count - 1, slot);
+        loaded++;
+
+        // Records are only read back to build the indices, so
+        // each value of an indexed field is kept with the
+        // record id instead
+        for (int i = 0; i < typed_values.size(); i++)
+        {
+            if (has_index(i))
+                postings[i].push_back(KeyRid(typed_values[i], rid));
+
+            widen_range(i, typed_values[i]);
+        }
+    }
+
+    // The codes of new dictionary strings are in the
+    // pages, so the strings are forced to disk first
+    Dictionary::sync_all();
+
+    if (loaded > 0 && !columnar)
+        buffer_pool.append_pages(file_id, batch, batch_count);
+
+    delete[] batch;
+
+    record_number += loaded;
+    info->records = record_number;
+
+    // Each index is rebuilt bottom up from its old keys merged
+    // with the new ones in key order.  New record ids are larger
+    // than every old one so they go at the end of each list.
+    for (int i = 0; i < field_names.size() && loaded > 0; i++)
+    {
+        if (!has_index(i))
+            continue;
+
+        jmiller::Vector<KeyRid>& keys = postings[i];
+        ColumnIndex& index = indices[field_names[i]];
+        index_iter it;
+        int k;
+
+        std::sort(&keys[0], &keys[0] + keys.size());
+
+        merged.clear();
+        it = index.begin();
+        k = 0;
+
+        while (it != index.end() || k < keys.size())
+        {
+            if (k == keys.size() || (it != index.end() && (*it).key < keys[k].key))
+            {
+                merged.push_back(*it);
+                ++it;
+            }
+            else
+            {
+                if (it != index.end() && (*it).key == keys[k].key)
+                {
+                    merged.push_back(*it);
+                    ++it;
+                }
+                else
+                    merged.emplace_back(keys[k].key);
+
+                Pair<Value, RowSet>& entry = merged[merged.size() - 1];
+
+                for (; k < keys.size() && keys[k].key == entry.key; k++)
+                    entry.value.add(keys[k].rid);
+
+                entry.value.optimize();
+            }
+        }
+
+        index.bulk_load(merged);
+
+        IndexFile index_file(index_file_name(field_names[i]));
+        index_file.write(index, field_types[i], last_rid());
+    }
+
+    // Writes the header page and forces the new pages
+    // to disk, which also clears the LOAD record
+    log_manager.checkpoint(log);
+
+    return loaded;
+}
+
+std::size_t Table::delete_from(const Vectorstr& conditions)
+{
+    jmiller::Vector<std::size_t> recnos;
+    jmiller::Vector<Value> values;
+    jmiller::Vector<jmiller::Vector<KeyRid> > postings;
+    jmiller::Vector<std::size_t> covered;
+    std::size_t deleted;
+
+    if (file_id < 0)
+        return 0;
+
+    if (conditions.size() == 0)
+        recnos = all_recnos();
+    else
+        recnos = get_conditional_indices(conditions).rows();
+
+    for (int i = 0; i < field_names.size(); i++)
+        postings.emplace_back();
+
+    covered = index_coverage();
+    deleted = 0;
+
+    // Each record is read before it's deleted since its
+    // values say where it is in each index.  A row table's
+    // record leaves a tombstone in its slot and a columnar
+    // table's row is marked in its tombstone bitmap.
+    for (int i = 0; i < recnos.size(); i++)
+    {
+        values = read_values(recnos[i]);
+
+        if (values.size() == 0)
+            continue;
+
+        // The keys the record is filed under are logged ahead
+        // of its delete, so recover() can take it out of the
+        // index files if the delete is replayed
+        log_index_entries(recnos[i], values, covered);
+
+        if (!erase_record(recnos[i]))
+            continue;
+
+        if (!columnar)
+            add_free_page(Page::page_of(recnos[i]));
+
+        log->append(WriteAheadLog::DELETE, recnos[i], NULL, 0);
+        deleted++;
+
+        for (int j = 0; j < values.size(); j++)
+        {
+            postings[j].push_back(KeyRid(values[j], recnos[i]));
+
+            if (index_loaded[field_names[j]])
+                indices[field_names[j]][values[j]].remove(recnos[i]);
+        }
+    }
+
+    record_number -= deleted;
+    info->records = record_number;
+
+    // The index files are told which records are gone
+    // without being written again, once the deletes are
+    // committed
+    queue_index_entries(postings, true, covered);
+
+    return deleted;
+}
+
+std::size_t Table::update(const Vectorstr& fields, const Vectorstr& values,
+                          const Vectorstr& conditions)
+{
+    jmiller::Vector<std::size_t> recnos;
+    jmiller::Vector<std::size_t> cols;
+    jmiller::Vector<Value> new_values;
+    jmiller::Vector<Value> old_row;
+    jmiller::Vector<Value> row;
+    jmiller::Vector<bool> changed;
+    jmiller::Vector<jmiller::Vector<KeyRid> > removed;
+    jmiller::Vector<jmiller::Vector<KeyRid> > added;
+    jmiller::Vector<std::size_t> covered;
+    Value value;
+    std::size_t recno;
+    std::size_t updated;
+    bool any_changed;
+    int col;
+
+    if (file_id < 0)
+        return 0;
+
+    // Every new value is read as its field's type before
+    // any record is touched
+    for (int i = 0; i < fields.size() && i < values.size(); i++)
+    {
+        if (!field_indices.contains(fields[i]))
+        {
+            std::cout << fields[i] << " is not a field of " << table_name << "." << std::endl;
+            return 0;
+        }
+
+        col = field_indices[fields[i]];
+
+        if (!parse_value(col, values[i], value))
+        {
+            std::cout << "\"" << values[i] << "\" is not a valid "
+                      << field_types[col].name() << " for " << field_names[col] << "." << std::endl;
+            return 0;
+        }
+
+        cols.push_back(col);
+        new_values.push_back(value);
+    }
+
+    if (conditions.size() == 0)
+        recnos = all_recnos();
+    else
+        recnos = get_conditional_indices(conditions).rows();
+
+    for (int i = 0; i < field_names.size(); i++)
+    {
+        removed.emplace_back();
+        added.emplace_back();
+    }
+
+    covered = index_coverage();
+    updated = 0;
+
+    for (int i = 0; i < recnos.size(); i++)
+    {
+        old_row = read_values(recnos[i]);
+
+        if (old_row.size() == 0)
+            continue;
+
+        // Only the fields given a different value count
+        // as changed.  A record with none is left alone.
+        row = old_row;
+        changed.clear();
+        any_changed = false;
+
+        for (int j = 0; j < row.size(); j++)
+            changed.push_back(false);
+
+        for (int j = 0; j < cols.size(); j++)
+            if (row[cols[j]] != new_values[j])
+            {
+                row[cols[j]] = new_values[j];
+                changed[cols[j]] = true;
+                any_changed = true;
+            }
+
+        if (!any_changed)
+            continue;
+
+        // The keys the record is filed under are logged ahead
+        // of the update.  A record which has to be moved leaves
+        // every index, so all of them are logged.
+        log_index_entries(recnos[i], old_row, covered);
+
+        recno = rewrite_record(recnos[i], row, changed);
+
+        if (recno == 0)
+            continue;
+
+        updated++;
+
+        // A record which kept its rid only moves in the
+        // indices of the fields which changed.  One which
+        // had to be moved has a new rid in every index.
+        for (int j = 0; j < row.size(); j++)
+        {
+            if (!changed[j] && recno == recnos[i])
+                continue;
+
+            removed[j].push_back(KeyRid(old_row[j], recnos[i]));
+            added[j].push_back(KeyRid(row[j], recno));
+
+            if (index_loaded[field_names[j]])
+            {
+                indices[field_names[j]][old_row[j]].remove(recnos[i]);
+                indices[field_names[j]][row[j]].add(recno);
+            }
+
+            if (changed[j])
+                widen_range(j, row[j]);
+        }
+    }
+
+    // The old entries are taken out of the index files
+    // before the new ones go in, since a moved record's
+    // rid may have been given to another record.  Neither
+    // is written until the update is committed.
+    queue_index_entries(removed, true, covered);
+    queue_index_entries(added, false, covered);
+
+    return updated;
+}
+
+void Table::compact()
+{
+    Page* page;
+    const Page* view;
+    std::size_t last;
+    bool dead;
+
+    if (file_id < 0)
+        return;
+
+    // Each page with tombstones is packed on its own so
+    // only the page being packed is pinned at a time.  The
+    // pages are found again for the free list, lowest page
+    // last since new records take the last one first.
+    if (!columnar)
+    {
+        info->free_pages.clear();
+
+        for (long page_no = buffer_pool.page_count(file_id) - 1; page_no >= 1; page_no--)
+        {
+            view = buffer_pool.read(file_id, page_no);
+            dead = view != NULL && view->dead_count() > 0;
+
+            if (view != NULL)
+                buffer_pool.release(file_id, page_no, view);
+
+            if (!dead)
+                continue;
+
+            page = buffer_pool.fetch(file_id, page_no);
+
+            if (page == NULL)
+                continue;
+
+            page->compact();
+            buffer_pool.unpin(file_id, page_no, true);
+            info->free_pages.push_back(page_no);
+        }
+    }
+
+    // Each index file is written as a new snapshot which
+    // leaves out the entries appended since the last one
+    last = last_rid();
+
+    for (int i = 0; i < field_names.size(); i++)
+    {
+        if (!has_index(i))
+            continue;
+
+        load_index(field_names[i]);
+
+        IndexFile index_file(index_file_name(field_names[i]));
+        index_file.write(indices[field_names[i]], field_types[i], last);
+    }
+}
+
+bool Table::create_index(const std::string& field, const std::string& kind)
+{
+    int index_kind;
+    std::size_t col;
+
+    if (file_id < 0)
+        return false;
+
+    if (!field_indices.contains(field))
+    {
+        std::cout << field << " is not a field of " << table_name << "." << std::endl;
+        return false;
+    }
+
+    if (!ColumnIndex::parse_kind(kind, index_kind))
+    {
+        std::cout << kind << " is not a kind of index." << std::endl;
+        return false;
+    }
+
+    col = field_indices[field];
+
+    // A field without an index starts from an empty index
+    // file, so one left by a dropped index or an old table
+    // of the same name isn't read.  load_index() then adds
+    // every record from the table and writes the file.
+    if (!has_index(col))
+    {
+        indices[field] = ColumnIndex(index_kind);
+        index_loaded[field] = false;
+        info->columns[col].index_kind = ColumnIndex::kind_name(index_kind);
+
+        IndexFile index_file(index_file_name(field));
+        index_file.write(indices[field], field_types[col], 0);
+    }
+
+    // The index is loaded in the form it has now and
+    // moved to the new one.  The index file is the same
+    // for every kind so it isn't written again.
+    load_index(field);
+    indices[field].set_kind(index_kind);
+    info->columns[col].index_kind = ColumnIndex::kind_name(index_kind);
+
+    // The catalog is saved when the table is
+    // checkpointed, which keeps the new kind
+    log_manager.checkpoint(log);
+
+    return true;
+}
+
+bool Table::drop_index(const std::string& field)
+{
+    std::size_t col;
+
+    if (file_id < 0)
+        return false;
+
+    if (!field_indices.contains(field))
+    {
+        std::cout << field << " is not a field of " << table_name << "." << std::endl;
+        return false;
+    }
+
+    col = field_indices[field];
+
+    if (!has_index(col))
+    {
+        std::cout << field << " has no index." << std::endl;
+        return false;
+    }
+
+    // Conditions on the field are answered by reading
+    // the table from now on, and nothing keeps its
+    // index file up to date, so the file is removed
+    info->columns[col].index_kind = "none";
+    indices[field] = ColumnIndex();
+    index_loaded[field] = false;
+    log_manager.checkpoint(log);
+    std::remove(index_file_name(field).c_str());
+
+    return true;
+}
+
+Vectorstr Table::split_line(const std::string& line, char delimiter)
+{
+    Vectorstr values;
+    std::string value;
+    bool quoted;
+
+    quoted = false;
+
+    // Splits on the delimiter except inside double quotes.
+    // A pair of quotes inside a quoted value is one quote.
+    for (std::size_t i = 0; i < line.size(); i++)
+    {
+        if (quoted)
+        {
+            if (line[i] == '"' && i + 1 < line.size() && line[i + 1] == '"')
+                value += line[i++];
+            else if (line[i] == '"')
+                quoted = false;
+            else
+                value += line[i];
+        }
+        else if (line[i] == '"')
+            quoted = true;
+        else if (line[i] == delimiter)
+        {
+            values.push_back(std::move(value));
+            value.clear();
+        }
+        else
+            value += line[i];
+    }
+
+    values.push_back(std::move(value));
+    return values;
+}
+
+void Table::set_fields(const Vectorstr& fields, const Vectorstr& types)
+{
+    FieldType type;
+
+    for (int i = 0; i < fields.size(); i++)
+    {
+        // Fields without a type are varchar
+        type = FieldType();
+        if (i < types.size())
+            FieldType::parse(types[i], type);
+
+        field_types.push_back(type);
+
+        // Creates a map of the fields to their index
+        // i.e. {first_name : 0, last_name : 1, dept : 2}
+        field_names.push_back(fields[i]);
+
+        // Creates a map with the field mapped to its index
+        field_indices.insert(fields[i], i);
+
+        // Creates a Map with each key being a field from 
+        // the vector passed into the function. 
+        // Each key maps to a map whose keys are the values
+        // for each field, and whose values are sets of all
+        // record numbers associated with those values.
+        // i.e. { first_name : { John : {12, 23, 43, 76}, Joe : {24, 35} } }
+        indices.create_key(fields[i]);
+
+        // Indices start unloaded and are read from their
+        // index files on demand.
+        index_loaded.insert(fields[i], false);
+    }
+}
+
+bool Table::valid_types(const Vectorstr& types)
+{
+    FieldType type;
+
+    for (int i = 0; i < types.size(); i++)
+        if (!FieldType::parse(types[i], type))
+        {
+            std::cout << "Unknown type " << types[i] << "." << std::endl;
+            return false;
+        }
+
+    return true;
+}
+
+std::string Table::index_file_name(const std::string& field)
+{
+    return info->columns[field_indices[field]].index_file;
+}
+
+std::string Table::log_file_name()
+{
+    return ".\\bin\\" + table_name + ".wal";
+}
+
+std::string Table::column_file_name(const std::string& field)
+{
+    return ".\\bin\\" + table_name + "_" + field + ".col";
+}
+
+std::string Table::dictionary_file_name(const std::string& field)
+{
+    return ".\\bin\\" + table_name + "_" + field + ".dict";
+}
+
+std::string Table::tombstone_file_name()
+{
+    return ".\\bin\\" + table_name + ".del";
+}
+
+void Table::open_dictionaries(bool create)
+{
+    dictionaries.clear();
+
+    for (int i = 0; i < field_types.size(); i++)
+        if (field_types[i].type == FieldType::DICT)
+            dictionaries.push_back(Dictionary::open(dictionary_file_name(field_names[i]), create));
+        else
+            dictionaries.push_back(NULL);
+}
+
+bool Table::parse_value(int col, const std::string& text, Value& value)
+{
+    uint32_t code;
+
+    // A dict field's string is stored and indexed as its
+    // code, which is added to the dictionary if it's new
+    if (dictionaries[col] != NULL)
+    {
+        code = dictionaries[col]->encode(text);
+        value = Value::decode(field_types[col], (const char*)&code, sizeof(code));
+        return true;
+    }
+
+    return Value::parse(field_types[col], text, value);
+}
+
+std::string Table::value_text(int col, const Value& value) const
+{
+    if (dictionaries[col] != NULL)
+        return dictionaries[col]->decode(value.to_int());
+
+    return value.to_string();
+}
+
+void Table::widen_range(int col, const Value& value)
+{
+    Value text;
+
+    // The range of a dict field is kept as strings
+    // since its codes aren't in string order
+    if (dictionaries[col] != NULL)
+    {
+        Value::parse(FieldType(), value_text(col, value), text);
+        info->columns[col].widen(text);
+    }
+    else
+        info->columns[col].widen(value);
+}
+
+void Table::open_catalog()
+{
+    if (catalog.loaded())
+        return;
+
+    catalog.load(".\\bin\\catalog.cat");
+    log_manager.set_checkpoint_hook(&Table::checkpointed);
+}
+
+void Table::commit()
+{
+    bool force;
+
+    // New dictionary strings must be on disk before
+    // any log record which uses their codes
+    Dictionary::sync_all();
+    log_manager.commit();
+
+    // An index file can't be ahead of its table, so the
+    // entries a statement left for the index files wait
+    // until its log records can't be lost.  A statement
+    // which changed records an index file covers has its
+    // log forced to disk whatever the commit policy.  New
+    // records wait for the policy to force it.
+    force = false;
+
+    for (int i = 0; i < pending_entries.size() && !force; i++)
+        force = !pending_entries[i].extends;
+
+    if (force)
+        log_manager.sync();
+
+    if (pending_entries.size() > 0 && log_manager.synced())
+        write_index_entries("");
+}
+
+void Table::sync()
+{
+    // Forces what commit() may have left for later, such
+    // as the last statements of a group when no more follow
+    // and the index entries which were waiting for them
+    Dictionary::sync_all();
+    log_manager.sync();
+    write_index_entries("");
+}
+
+uint64_t Table::checkpointed(const std::string& table_file)
+{
+    // The table's pages are on disk, so the entries left for
+    // its index files are written before the log records
+    // which also hold them are thrown away
+    write_index_entries(table_file);
+
+    return catalog.checkpoint(table_file);
+}
+
+void Table::open_columns(bool create)
+{
+    std::string name;
+
+    columns.clear();
+
+    // The table's log covers every column file so they're
+    // written back along with the table file at a checkpoint
+    for (int i = 0; i < field_names.size(); i++)
+    {
+        name = column_file_name(field_names[i]);
+        columns.push_back(ColumnFile(&buffer_pool, name, create));
+        log->cover(name);
+    }
+
+    tombstones = Tombstones(&buffer_pool, tombstone_file_name(), create);
+    log->cover(tombstone_file_name());
+}
+
+std::size_t Table::append_columns(const Vectorstr& values, std::size_t row)
+{
+    // Every column gets its value at the same row id.  If
+    // one can't be written the others are cut back to the
+    // row before it.
+    for (int i = 0; i < columns.size(); i++)
+        if (columns[i].append(values[i].data(), values[i].size()) != (long)row)
+        {
+            std::cout << "Value for " << field_names[i] << " could not be stored." << std::endl;
+            truncate_columns(row - 1);
+            return 0;
+        }
+
+    return row;
+}
+
+std::size_t Table::column_rows() const
+{
+    std::size_t rows;
+
+    // A columnar table has as many records
+    // as its shortest column
+    rows = columns.size() > 0 ? columns[0].row_count() : 0;
+
+    for (int i = 1; i < columns.size(); i++)
+        if (columns[i].row_count() < (long)rows)
+            rows = columns[i].row_count();
+
+    return rows;
+}
+
+void Table::truncate_columns(std::size_t rows)
+{
+    for (int i = 0; i < columns.size(); i++)
+        if (columns[i].row_count() > (long)rows)
+            columns[i].truncate(rows);
+
+    tombstones.truncate(rows);
+}
+
+std::size_t Table::last_rid() const
+{
+    const Page* page;
+    std::size_t last;
+
+    if (columnar)
+        return column_rows();
+
+    last = 0;
+
+    // The last slot of the last data page, whether or
+    // not its record has been deleted
+    for (long page_no = buffer_pool.page_count(file_id) - 1; page_no >= 1 && last == 0; page_no--)
+    {
+        page = buffer_pool.read(file_id, page_no);
+
+        if (page != NULL && page->slot_count() > 0)
+            last = Page::rid(page_no, page->slot_count() - 1);
+
+        if (page != NULL)
+            buffer_pool.release(file_id, page_no, page);
+    }
+
+    return last;
+}
+
+bool Table::erase_record(std::size_t recno)
+{
+    Page* page;
+    long page_no;
+    bool erased;
+
+    if (columnar)
+        return tombstones.mark(recno);
+
+    page_no = Page::page_of(recno);
+
+    if (page_no < 1 || page_no >= buffer_pool.page_count(file_id))
+        return false;
+
+    page = buffer_pool.fetch(file_id, page_no);
+
+    if (page == NULL)
+        return false;
+
+    erased = page->erase(Page::slot_of(recno));
+    buffer_pool.unpin(file_id, page_no, erased);
+
+    return erased;
+}
+
+std::size_t Table::place_record(Record& record, const Vectorstr& encoded, bool& reused)
+{
+    std::size_t recno;
+
+    // A row table puts the record in the slot of a deleted
+    // record if one of its pages has one, and a page which
+    // turns out not to is forgotten
+    recno = 0;
+    reused = false;
+
+    while (!columnar && recno == 0 && info->free_pages.size() > 0)
+    {
+        recno = record.reuse(buffer_pool, file_id, info->free_pages[info->free_pages.size() - 1]);
+        reused = recno != 0;
+
+        if (!reused)
+            info->free_pages.pop_back();
+    }
+
+    if (columnar)
+        recno = append_columns(encoded, column_rows() + 1);
+    else if (!reused)
+        recno = record.write(buffer_pool, file_id);
+
+    return recno;
+}
+
+std::size_t Table::rewrite_record(std::size_t recno, const jmiller::Vector<Value>& row,
+                                  const jmiller::Vector<bool>& changed)
+{
+    Vectorstr encoded;
+    std::size_t new_recno;
+    bool in_place;
+    bool reused;
+
+    for (int i = 0; i < row.size(); i++)
+        encoded.push_back(row[i].encode(field_types[i]));
+
+    Record new_record(encoded);
+
+    if (!new_record.valid())
+    {
+        std::cout << "Record is too large to fit in a page." << std::endl;
+        return 0;
+    }
+
+    // The record is written over itself so its rid stays
+    // the same.  Only the changed values of a columnar row
+    // are written, each into its own column.
+    in_place = true;
+
+    if (columnar)
+    {
+        for (int i = 0; i < columns.size() && in_place; i++)
+            if (changed[i])
+                in_place = columns[i].update(recno, encoded[i].data(), encoded[i].size());
+    }
+    else
+        in_place = new_record.rewrite(buffer_pool, file_id, recno);
+
+    if (in_place)
+    {
+        log->append(WriteAheadLog::UPDATE, recno, new_record.data(), new_record.size());
+        return recno;
+    }
+
+    // A record which has grown too big for its page is
+    // written again somewhere else before the old one is
+    // deleted, so it's never lost in between
+    new_recno = place_record(new_record, encoded, reused);
+
+    if (new_recno == 0)
+        return 0;
+
+    log->append(WriteAheadLog::INSERT, new_recno, new_record.data(), new_record.size());
+    erase_record(recno);
+
+    if (!columnar)
+        add_free_page(Page::page_of(recno));
+
+    log->append(WriteAheadLog::DELETE, recno, NULL, 0);
+
+    return new_recno;
+}
+
+void Table::add_free_page(long page_no)
+{
+    for (int i = 0; i < info->free_pages.size(); i++)
+        if (info->free_pages[i] == (uint64_t)page_no)
+            return;
+
+    info->free_pages.push_back(page_no);
+}
+
+jmiller::Vector<std::size_t> Table::index_coverage()
+{
+    jmiller::Vector<std::size_t> covered;
+
+    // The last record each field's index file covers, or 0
+    // for a field without an index
+    for (int i = 0; i < field_names.size(); i++)
+        covered.push_back(has_index(i) ?
+                          IndexFile(index_file_name(field_names[i])).last_indexed() : 0);
+
+    // or will cover once the new records waiting for
+    // it are written, so changes to them follow them
+    for (int i = 0; i < pending_entries.size(); i++)
+    {
+        if (!pending_entries[i].extends || pending_entries[i].table_file != file_name)
+            continue;
+
+        for (int j = 0; j < field_names.size(); j++)
+            if (pending_entries[i].index_file == index_file_name(field_names[j]) &&
+                pending_entries[i].last > covered[j])
+                covered[j] = pending_entries[i].last;
+    }
+
+    return covered;
+}
+
+void Table::log_index_entries(std::size_t rid, const jmiller::Vector<Value>& row,
+                              const jmiller::Vector<std::size_t>& covered)
+{
+    std::string data;
+    uint32_t field;
+
+    // An INDEX record holds the field and the key.  Records
+    // after the ones an index file covers are read from the
+    // table when the index is next loaded, so they're left out.
+    for (int i = 0; i < row.size(); i++)
+    {
+        if (rid > covered[i])
+            continue;
+
+        field = i;
+        data.assign((const char*)&field, sizeof(field));
+        data += row[i].encode(field_types[i]);
+
+        log->append(WriteAheadLog::INDEX, rid, data.data(), data.size());
+    }
+}
+
+void Table::queue_index_entries(const jmiller::Vector<jmiller::Vector<KeyRid> >& postings,
+                                bool removed, const jmiller::Vector<std::size_t>& covered)
+{
+    // Only the records an index file already covers are
+    // added to it.  The ones after it are read from the
+    // table when the index is next loaded.
+    for (int i = 0; i < postings.size(); i++)
+        for (int j = 0; j < postings[i].size(); j++)
+            if (postings[i][j].rid <= covered[i])
+                queue_index_entry(i, removed, postings[i][j].key, postings[i][j].rid);
+}
+
+void Table::queue_index_entry(std::size_t col, bool removed, const Value& key, std::size_t rid)
+{
+    std::string name;
+    name = index_file_name(field_names[col]);
+
+    // Entries in a row for the same file which all add or
+    // all remove are written together
+    if (pending_entries.size() == 0 ||
+        pending_entries[pending_entries.size() - 1].index_file != name ||
+        pending_entries[pending_entries.size() - 1].removed != removed)
+    {
+        pending_entries.emplace_back();
+
+        IndexEntries& added = pending_entries[pending_entries.size() - 1];
+        added.table_file = file_name;
+        added.index_file = name;
+        added.type = field_types[col];
+        added.removed = removed;
+        added.extends = false;
+        added.after = 0;
+        added.last = 0;
+    }
+
+    pending_entries[pending_entries.size() - 1].entries.push_back(
+        MPair<Value, std::size_t>(key, rid));
+}
+
+void Table::queue_new_entry(std::size_t col, const Value& key, std::size_t rid, std::size_t after)
+{
+    std::string name;
+    int last;
+    name = index_file_name(field_names[col]);
+
+    // The file's latest entries, which the entries of other
+    // files queued since don't have to be written before
+    last = pending_entries.size() - 1;
+
+    while (last >= 0 && pending_entries[last].index_file != name)
+        last--;
+
+    // A record which follows the last one of those entries
+    // is written with them
+    if (last < 0 || !pending_entries[last].extends ||
+        pending_entries[last].last != after)
+    {
+        pending_entries.emplace_back();
+        last = pending_entries.size() - 1;
+
+        IndexEntries& added = pending_entries[last];
+        added.table_file = file_name;
+        added.index_file = name;
+        added.type = field_types[col];
+        added.removed = false;
+        added.extends = true;
+        added.after = after;
+    }
+
+    pending_entries[last].last = rid;
+    pending_entries[last].entries.push_back(MPair<Value, std::size_t>(key, rid));
+}
+
+void Table::write_index_entries(const std::string& table_file)
+{
+    jmiller::Vector<IndexEntries> waiting;
+
+    // Writes the entries of table_file, or of every table if
+    // it's empty, in the order they were made.  The rest wait.
+    for (int i = 0; i < pending_entries.size(); i++)
+    {
+        if (!table_file.empty() && pending_entries[i].table_file != table_file)
+        {
+            waiting.push_back(std::move(pending_entries[i]));
+            continue;
+        }
+
+        IndexFile index_file(pending_entries[i].index_file);
+        index_file.append(pending_entries[i].entries, pending_entries[i].type,
+                          pending_entries[i].removed);
+
+        if (pending_entries[i].extends)
+            index_file.extend(pending_entries[i].after, pending_entries[i].last);
+    }
+
+    pending_entries = std::move(waiting);
+}
+
+void Table::requeue_index_entries(const jmiller::Vector<jmiller::Vector<KeyRid> >& keys)
+{
+    jmiller::Vector<std::size_t> covered;
+    jmiller::Vector<std::size_t> cols;
+    jmiller::Vector<Value> values;
+    std::size_t rid;
+
+    covered = index_coverage();
+
+    // Each key is filed under its record, or taken out of
+    // it, by what the record holds now.  An entry which got
+    // to the file before is only written again.
+    for (int i = 0; i < keys.size(); i++)
+    {
+        cols.clear();
+        cols.push_back(i);
+
+        for (int j = 0; j < keys[i].size(); j++)
+        {
+            rid = keys[i][j].rid;
+
+            if (rid > covered[i])
+                continue;
+
+            values = read_values(rid, cols);
+            queue_index_entry(i, values.size() == 0 || values[0] != keys[i][j].key,
+                              keys[i][j].key, rid);
+        }
+    }
+}
+
+void Table::recover()
+{
+    Record record;
+    Vectorstr fields;
+    std::string data;
+    jmiller::Vector<std::size_t> recnos;
+    jmiller::Vector<Value> row;
+    jmiller::Vector<jmiller::Vector<KeyRid> > index_keys;
+    Value value;
+    std::size_t start;
+    uint32_t field;
+    bool is_new;
+    bool replayed;
+    bool truncated;
+    bool counted;
+    bool loading;
+    int type;
+    long rid;
+
+    log = log_manager.open(log_file_name(), file_name, is_new);
+
+    // The column files are opened once the log is
+    // so that it covers them
+    if (columnar)
+        open_columns(false);
+
+    // A log which was already open in this program only
+    // holds changes which are still in the buffer pool
+    if (!is_new)
+        return;
+
+    // The records in the log come after the catalog's count
+    // if the log started at the catalog's last checkpoint.
+    // Otherwise the program stopped after the catalog was
+    // saved at a checkpoint but before the log was emptied,
+    // and the catalog already counts them.
+    counted = (log->epoch() == info->epoch);
+
+    for (int i = 0; i < field_names.size(); i++)
+        index_keys.emplace_back();
+
+    start = record_number;
+    replayed = false;
+    truncated = false;
+    loading = false;
+
+    // The pages of a row table may have been written back
+    // at any point after the checkpoint, so the slots the
+    // log changes are emptied first.  Replaying the log in
+    // order then never needs more room in a page than it
+    // had when the records were first written.
+    log->rewind();
+
+    while (!columnar && log->next(type, rid, data))
+        if (type == WriteAheadLog::INSERT || type == WriteAheadLog::DELETE ||
+            type == WriteAheadLog::UPDATE)
+            erase_record(rid);
+
+    // The same goes for the values of a columnar table's
+    // updated rows, which are changed where they are
+    log->rewind();
+
+    while (columnar && log->next(type, rid, data))
+        if (type == WriteAheadLog::UPDATE)
+            for (int i = 0; i < columns.size(); i++)
+                columns[i].erase(rid);
+
+    // Replays every logged record which didn't make it to
+    // the table file before the program last stopped
+    log->rewind();
+
+    while (log->next(type, rid, data))
+    {
+        if (type == WriteAheadLog::CHECKPOINT)
+            continue;
+
+        replayed = true;
+
+        // The rows before the first logged insert or load were
+        // all checkpointed.  Column pages past them may have
+        // been written back out of order, so they're cut off
+        // and added again from the log.  The rows of a load
+        // which didn't finish are dropped.
+        if (columnar && !truncated &&
+            (type == WriteAheadLog::INSERT || type == WriteAheadLog::LOAD))
+        {
+            truncate_columns(type == WriteAheadLog::LOAD ? rid : rid - 1);
+            truncated = true;
+        }
+
+        if (type == WriteAheadLog::LOAD)
+            loading = true;
+
+        if (type == WriteAheadLog::DELETE)
+        {
+            erase_record(rid);
 
-    // MUTATORS
-    std::size_t insert_into(const Vectorstr values);
-    Table select(const Vectorstr columns, const Vectorstr rows);
-    Table select_all();
+            if (!columnar)
+                add_free_page(Page::page_of(rid));
 
+            if (counted)
+                record_number--;
 
-    // PRINT FUNCTION
-    friend std::ostream& operator<<(std::ostream& outs,
-                                    const Table& print_me)
-    {
-        std::fstream fs;
-        Vectorstr fields;
-        Record reader;
-        std::size_t recno;
-        int counter;
-        counter = 1;
-        
-        fs.open(print_me.file_name.c_str(), 
-                std::fstream::in | std::fstream::out | std::fstream::binary);
+            continue;
+        }
 
-        std::cout << "\n\nTable name: " << print_me.table_name 
-                  << ", records: " << print_me.record_number << std::endl << std::endl;
+        // The index files are only told of a statement once
+        // it's committed, so the program may have stopped
+        // before they were.  The keys a record had before a
+        // delete or update are in INDEX records, and the keys
+        // it has after an insert or update in the record.
+        if (type == WriteAheadLog::INDEX)
+        {
+            if (data.size() < sizeof(field))
+                continue;
 
-        std::cout << std::setw(11) << std::left << "  Record ";
+            memcpy(&field, data.data(), sizeof(field));
 
-        for (int i = 0; i < print_me.field_names.size(); i++)
-            std::cout << std::setw(16) << std::left << print_me.field_names[i];
+            if (field < field_names.size() && has_index(field))
+                index_keys[field].push_back(
+                    KeyRid(Value::decode(field_types[field], data.data() + sizeof(field),
+                                         data.size() - sizeof(field)), rid));
 
-        std::cout <<  "\n  -------------------------------------------------------------------------------------"
-                  << std::endl;
+            continue;
+        }
 
-        std::cout << std::endl;
-        recno = 1;
+        if (type != WriteAheadLog::INSERT && type != WriteAheadLog::UPDATE)
+            continue;
 
-        while (recno <= print_me.record_number)
+        record.set(data.data(), data.size());
+        fields = record.get_fields();
+
+        // An update is written over the row or record
+        // at its rid and doesn't change the count
+        if (columnar && type == WriteAheadLog::UPDATE)
         {
-            recno += reader.read(fs, recno);
-            fields = reader.get_fields();
-            std::cout << std::setw(7) << std::right << counter++ << std::setw(4) << std::left << ".";
+            for (int i = 0; i < columns.size() && i < fields.size(); i++)
+                columns[i].update(rid, fields[i].data(), fields[i].size());
+        }
+        else if (columnar)
+        {
+            for (int i = 0; i < columns.size() && i < fields.size(); i++)
+                columns[i].redo(rid, fields[i].data(), fields[i].size());
+        }
+        else
+            record.redo(buffer_pool, file_id, rid);
 
-            for (int i = 0; i < fields.size(); i++)
-                std::cout << std::setw(16) << std::left << fields[i];
-            
-            std::cout << std::endl;
+        if (counted && type == WriteAheadLog::INSERT)
+            record_number++;
+
+        for (int i = 0; i < fields.size() && i < field_types.size(); i++)
+        {
+            value = Value::decode(field_types[i], fields[i].data(), fields[i].size());
+            widen_range(i, value);
+
+            if (has_index(i))
+                index_keys[i].push_back(KeyRid(value, rid));
         }
+    }
 
-        std::cout << "\n\n" << std::endl;
-        return outs;
+    // A log emptied by a checkpoint which stopped before it
+    // could be restarted is given the catalog's epoch
+    if (!replayed)
+    {
+        if (log->epoch() != info->epoch)
+        {
+            log->restart(info->epoch);
+            log->sync();
+        }
+
+        return;
     }
-    
- private:
-    static std::size_t serial;
-    Map<std::string, int> precedence;
-    std::string table_name;
-    std::string file_name;
-    mmap_map indices;
-    Vectorstr field_names;
-    Map<std::string, std::size_t> field_indices;
-    bool empty;
-    std::size_t record_number;
 
-    void set_prec();
-    void set_fields(const Vectorstr& field_names);
-    jmiller::Vector<std::size_t> get_conditional_indices(const Vectorstr& conditions);
-    jmiller::Vector<std::size_t> get_simple_indices(Vectorstr& s_conditions);
-    Vectorstr get_rpn(Vectorstr conditions);
-    jmiller::Vector<std::size_t> and_vector(jmiller::Vector<std::size_t> v1,
-                                            jmiller::Vector<std::size_t> v2);
-    jmiller::Vector<std::size_t> or_vector(jmiller::Vector<std::size_t> v1,
-                                            jmiller::Vector<std::size_t> v2);
-};
+    // A columnar table has as many rows as its shortest
+    // column, less the ones deleted.  The pages of a row
+    // table's unfinished load were written without being
+    // logged, so the records are counted and the new ones
+    // read for their ranges.
+    if (columnar)
+    {
+        truncate_columns(column_rows());
+        record_number = column_rows() - tombstones.count();
+    }
+    else if (loading && counted)
+    {
+        recnos = all_recnos();
+        record_number = recnos.size();
+
+        for (std::size_t i = start; i < recnos.size(); i++)
+        {
+            row = read_values(recnos[i]);
+
+            for (int j = 0; j < row.size(); j++)
+                widen_range(j, row[j]);
+        }
+    }
+
+    info->records = record_number;
+
+    // The index files are put right for every key found
+    // above, and written when the table is checkpointed
+    requeue_index_entries(index_keys);
 
-Table::Table(const std::string& name, const Vectorstr fields)
+    // The replayed pages are written to the table so
+    // the log can start over
+    log_manager.checkpoint(log);
+}
+
+jmiller::Vector<std::size_t> Table::all_recnos(std::size_t after) const
 {
-    table_name = name;
-    file_name = ".\\bin\\" + name + ".tbl";
-    record_number = 0;
-    set_fields(fields);
+    const Page* page;
+    long page_count;
+    long first_page;
+    std::size_t rows;
+    jmiller::Vector<std::size_t> recnos;
+
+    if (file_id < 0)
+        return recnos;
+
+    // The rows of a columnar table are numbered
+    // from 1, less the ones which were deleted
+    if (columnar)
+    {
+        if (after == 0)
+            recnos.reserve(record_number);
 
-    std::fstream fs;
-    Record field_record(fields);
+        rows = column_rows();
+
+        for (std::size_t row = after + 1; row <= rows; row++)
+            if (!tombstones.is_dead(row))
+                recnos.push_back(row);
+
+        return recnos;
+    }
+
+    page_count = buffer_pool.page_count(file_id);
+    first_page = (after == 0) ? 1 : Page::page_of(after);
+
+    if (after == 0)
+        recnos.reserve(record_number);
 
-    // Creates the file if it doesn't exist
-    fs.open(file_name.c_str(), std::fstream::out | std::fstream::binary);
-    fs.close();
+    // Only the slot directories are needed to know which
+    // slots hold records rather than tombstones.  The pages
+    // before the one holding after aren't read.
+    for (long page_no = first_page; page_no < page_count; page_no++)
+    {
+        page = buffer_pool.read(file_id, page_no);
 
-    // Opens the file for read / write
-    fs.open(file_name.c_str(), std::fstream::in | std::fstream::out | std::fstream::binary);
+        for (int slot = 0; slot < page->slot_count(); slot++)
+            if (!page->is_dead(slot) && Page::rid(page_no, slot) > after)
+                recnos.push_back(Page::rid(page_no, slot));
 
-    // Write the field names as the first record in the table
-    field_record.write(fs);
+        buffer_pool.release(file_id, page_no, page);
+    }
 
+    return recnos;
 }
 
-Table::Table(const std::string& name)
+Vectorstr Table::read_fields(std::size_t recno,
+                             const jmiller::Vector<std::size_t>& cols) const
 {
-    std::fstream fs;
-    Vectorstr values;
-    std::size_t recno;
-    Record fields_record;
+    jmiller::Vector<Value> values;
+    Vectorstr fields;
 
-    table_name = name;
-    file_name = ".\\bin\\" + name + ".tbl";
-    record_number = 0;
+    values = read_values(recno, cols);
 
-    fs.open(file_name.c_str(), std::fstream::out | std::fstream::in | std::fstream::binary);
-    recno = 1;
+    for (int i = 0; i < values.size(); i++)
+        fields.push_back(value_text(cols[i], values[i]));
 
-    if (fs.fail())
-        std::cout << file_name << " does not exist." << std::endl;
-    else
+    return fields;
+}
+
+jmiller::Vector<Value> Table::read_values(std::size_t recno) const
+{
+    jmiller::Vector<std::size_t> cols;
+
+    for (int i = 0; i < field_names.size(); i++)
+        cols.push_back(i);
+
+    return read_values(recno, cols);
+}
+
+jmiller::Vector<Value> Table::read_values(std::size_t recno,
+                                          const jmiller::Vector<std::size_t>& cols) const
+{
+    Record reader;
+    const Page* page;
+    std::string field;
+    jmiller::Vector<Value> values;
+    const char* data;
+    int length;
+    long page_no;
+
+    // Only the files of the fields asked for are
+    // read from a columnar table
+    if (columnar)
     {
-        fields_record.read(fs, 0);
-        values = fields_record.get_fields();
-        set_fields(values);
+        if (tombstones.is_dead(recno))
+            return values;
+
+        for (int i = 0; i < cols.size(); i++)
+        {
+            if (!columns[cols[i]].get(recno, field))
+                return jmiller::Vector<Value>();
+
+            values.push_back(Value::decode(field_types[cols[i]], field.data(), field.size()));
+        }
+
+        return values;
     }
 
-    // Creates the indices tree structure from the file
-    while (fields_record.read(fs, recno) != 0)
-    {
-        values = fields_record.get_fields();
+    page_no = Page::page_of(recno);
+    page = buffer_pool.read(file_id, page_no);
 
-        for (int i = 0; i < values.size(); i++)
-        {   
-            if (indices[field_names[i]].contains(values[i]))
-                indices[field_names[i]][values[i]].push_back(recno);
-            else
+    if (page == NULL)
+        return values;
+
+    // Only the fields asked for are read back from their
+    // binary form, straight out of the page without
+    // copying the record or its other fields
+    if (reader.read(*page, Page::slot_of(recno)))
+        for (int i = 0; i < cols.size(); i++)
+        {
+            if (!reader.get_field(cols[i], data, length))
             {
-                indices[field_names[i]].create_key(values[i]);
-                indices[field_names[i]][values[i]].push_back(recno);
+                values.clear();
+                break;
             }
+
+            values.push_back(Value::decode(field_types[cols[i]], data, length));
         }
 
-        recno++;
-        record_number++;
-    }  
+    buffer_pool.release(file_id, page_no, page);
+
+    return values;
 }
 
-std::size_t Table::insert_into(const Vectorstr values)
+void Table::take_indices()
 {
-    std::fstream fs;
-    Record new_record(values);
-    std::size_t recno;
+    std::string name;
 
-    // Open the binary file that stores the Records
-    fs.open(file_name.c_str(), std::fstream::binary | std::fstream::in | std::fstream::app);
+    // An index kept by the last statement on the table had
+    // every change it made, so it's as up to date as the
+    // table.  It's taken rather than shared so this table's
+    // changes go into it the same way.
+    for (int i = 0; i < field_names.size(); i++)
+    {
+        name = index_file_name(field_names[i]);
 
-    // Write the record and store its location in the file
-    // in recno
-    recno = new_record.write(fs);
+        if (!kept_indices.contains(name))
+            continue;
 
-    // For each value in values: 
-    //  1. If there already exists a key in the mmap for
-    //     values[i] then add the recno to the vector.
-    //  2. If there isn't a key in the mmap for values[i]
-    //     one is created and the recno pushed back.
-    for (int i = 0; i < values.size(); i++)
-    {   
-        if (indices[field_names[i]].contains(values[i]))
-            indices[field_names[i]][values[i]].push_back(recno);
-        else
+        if (has_index(i))
         {
-            indices[field_names[i]].create_key(values[i]);
-            indices[field_names[i]][values[i]].push_back(recno);
+            indices[field_names[i]] = std::move(kept_indices[name]);
+            index_loaded[field_names[i]] = true;
         }
-    }  
 
-    record_number = recno;
+        kept_indices.erase(name);
+    }
 }
 
-void Table::set_fields(const Vectorstr& fields)
+void Table::load_index(const std::string& field)
 {
-    for (int i = 0; i < fields.size(); i++)
+    jmiller::Vector<Value> values;
+    jmiller::Vector<std::size_t> recnos;
+    jmiller::Vector<std::size_t> cols;
+    std::size_t last;
+    std::size_t table_last;
+    std::size_t after;
+    std::size_t col;
+    int kind;
+
+    if (!field_indices.contains(field) || index_loaded[field] ||
+        !has_index(field_indices[field]))
+        return;
+
+    IndexFile index_file(index_file_name(field));
+    last = 0;
+
+    col = field_indices[field];
+    cols.push_back(col);
+
+    // The index is read into the form the
+    // catalog says the field's index takes
+    if (ColumnIndex::parse_kind(info->columns[col].index_kind, kind))
+        indices[field].set_kind(kind);
+
+    if (index_file.read(indices[field], field_types[col]))
     {
-        // Creates a map of the fields to their index
-        // i.e. {first_name : 0, last_name : 1, dept : 2}
-        field_names.push_back(fields[i]);
+        last = index_file.last_indexed();
 
-        // Creates a map with the field mapped to its index
-        field_indices.insert(fields[i], i);
+        // A file which has had more appended to it than its
+        // snapshot holds is written as a new snapshot
+        if (index_file.outgrown())
+            index_file.write(indices[field], field_types[col], last);
+    }
 
-        // Creates a Map with each key being a field from 
-        // the vector passed into the function. 
-        // Each key maps to a multimap whose keys are the
-        // values for each field, and whose values are vectors
-        // of all record numbers associated with those values.
-        // i.e. { first_name : { John : {12, 23, 43, 76}, Joe : {24, 35} } }
-        indices.create_key(fields[i]);
+    // Records written after the index file was last brought
+    // up to date (or every record, for a table without an
+    // index file) are read from the table and added.  New
+    // records go after the last one the file covers, except
+    // ones put in the slot of a deleted record, which the
+    // file is told about when they're written.  Only the
+    // pages from the one holding the last record the file
+    // covers are read, and only the field's own value.
+    table_last = last_rid();
+
+    if (last < table_last)
+    {
+        recnos = all_recnos(last);
+        after = last;
+
+        for (std::size_t i = 0; i < recnos.size(); i++)
+        {
+            values = read_values(recnos[i], cols);
+
+            if (values.size() == 0)
+                continue;
+
+            indices[field][values[0]].add(recnos[i]);
+
+            // They're appended to a file which already has
+            // a snapshot along with the ones inserted since
+            if (last > 0)
+                queue_new_entry(col, values[0], recnos[i], after);
+
+            after = recnos[i];
+        }
+
+        if (last == 0)
+            index_file.write(indices[field], field_types[col], table_last);
     }
+
+    index_loaded[field] = true;
+}
+
+bool Table::has_index(std::size_t col) const
+{
+    return info->columns[col].index_kind != "none";
 }
 
 Table Table::select_all()
 {
     Table t(this->table_name);
+
+    // Returning t moves its indices out rather than
+    // copying their trees
     return t;
 }
 
-Table Table::select(const Vectorstr columns, const Vectorstr conditions)
+Table::Cursor Table::select(const Vectorstr& columns, const Vectorstr& conditions)
 {
     jmiller::Vector<std::size_t> col_indices;
     jmiller::Vector<std::size_t> row_indices;
     Vectorstr act_columns;
-    Vectorstr raw_values;
-    Vectorstr selected_values;
-    Record reader;
-
-    std::string temp_table_name;
-
-    temp_table_name = "temp\\" + table_name + "_temp";
 
     if (columns[0] == "*")
         act_columns = field_names;
     else
         act_columns = columns;
 
-    Table t(temp_table_name, act_columns);
-    
     // Creates a vector storing the indices of the
-    // selected fields.
+    // selected fields
     for (int i = 0; i < act_columns.size(); i++)
         col_indices.push_back(field_indices[act_columns[i]]);
 
-    if (conditions.size() == 0)
-        for (std::size_t i = 1; i <= record_number; i++)
-            row_indices.push_back(i);
+    // The conditions are answered by the indices, and
+    // only the records they pick out are read.  Without
+    // conditions the cursor reads the table from the start
+    // and nothing is gathered up front.
+    if (conditions.size() > 0)
+        row_indices = get_conditional_indices(conditions).rows();
+
+    return Cursor(this, act_columns, col_indices, row_indices, conditions.size() == 0);
+}
+
+Table::Cursor::Cursor(const Table* t, const Vectorstr& names,
+                      const jmiller::Vector<std::size_t>& col_indices,
+                      const jmiller::Vector<std::size_t>& row_indices, bool scan)
+{
+    table = t;
+    table_name = t->table_name;
+    field_names = names;
+    cols = col_indices;
+    recnos = row_indices;
+    scanning = scan;
+    position = 0;
+    page_no = 0;
+    read_ahead = 0;
+    slot = 0;
+    slot_count = 0;
+
+    if (table->file_id < 0 || (scanning && table->columnar))
+        page_count = 0;
     else
-        row_indices = get_conditional_indices(conditions);
+        page_count = buffer_pool.page_count(table->file_id);
+
+    count = scanning ? table->record_number : recnos.size();
+}
+
+bool Table::Cursor::next()
+{
+    const Page* page;
+    std::size_t recno;
 
-    // Opens a fstream object for the binary file
-    std::fstream fs;
-    fs.open(file_name.c_str(), 
-            std::fstream::out | std::fstream::in | std::fstream::binary);
+    row.clear();
 
-    // Loop to read the records accoring to the condition,
-    // build a vector based on the selected fields, and
-    // insert that vector into the new table.
-    for (int i = 0; i < row_indices.size(); i++)
+    if (table->file_id < 0)
+        return false;
+
+    // Deleted records are passed over.  Only the fields
+    // which were selected are read, so a columnar table
+    // only reads their columns.
+    while (row.size() == 0)
     {
-        reader.read(fs, row_indices[i]);
-        raw_values = reader.get_fields();
+        if (!scanning)
+        {
+            if (position >= recnos.size())
+                return false;
 
-        for (int j = 0; j < col_indices.size(); j++)
-            selected_values.push_back(raw_values[col_indices[j]]);
+            recno = recnos[position++];
 
-        t.insert_into(selected_values);
-        selected_values.clear();
-    }
+            if (!table->columnar && Page::page_of(recno) > read_ahead)
+                read_ahead_of(Page::page_of(recno));
+        }
+        else if (table->columnar)
+        {
+            if (position >= table->column_rows())
+                return false;
 
-    return t;
-}
+            recno = ++position;
+        }
+        else
+        {
+            // A row table is read a page at a time.  The
+            // next page's slot count is read when the slots
+            // of the last one run out.
+            while (slot >= slot_count)
+            {
+                if (++page_no >= page_count)
+                    return false;
 
-jmiller::Vector<std::size_t> Table::and_vector(jmiller::Vector<std::size_t> v1,
-                                               jmiller::Vector<std::size_t> v2)
-{
-    jmiller::Vector<std::size_t> anded;
-    BTree<std::size_t> tree;
+                if (page_no > read_ahead)
+                    read_ahead_of(page_no);
 
-    // Inserts every item in v2 into the tree
-    for (int i = 0; i < v2.size(); i++)
-        tree.insert(v2[i]);
+                page = buffer_pool.read(table->file_id, page_no);
+                slot = 0;
+                slot_count = page == NULL ? 0 : page->slot_count();
 
-    // Checks every item in v1 agains the tree.
-    // If the tree contains the same item as v1
-    // then it belongs to the set (v1 and v2)
-    // and it added to the vector which will be returned
-    for (int i = 0; i < v1.size(); i++)
-    {
-        if (tree.contains(v1[i]))
-            anded.push_back(v1[i]);
+                if (page != NULL)
+                    buffer_pool.release(table->file_id, page_no, page);
+            }
+
+            recno = Page::rid(page_no, slot++);
+        }
+
+        row = table->read_fields(recno, cols);
     }
 
-    return anded;
-}                                               
+    return true;
+}
 
-jmiller::Vector<std::size_t> Table::or_vector(jmiller::Vector<std::size_t> v1,
-                                              jmiller::Vector<std::size_t> v2)
+void Table::Cursor::read_ahead_of(long first)
 {
-    jmiller::Vector<std::size_t> ored;
-    BTree<std::size_t> tree;
+    long last;
 
-    // Inserts every item in v2 into the tree
-    for (int i = 0; i < v2.size(); i++)
-        tree.insert(v2[i]);
+    // The pages the next records are in are read together
+    // before they're needed.  A scan reads the next pages
+    // of the table.  Rids are in order, so the pages of the
+    // rids coming up which are near this one make a run,
+    // along with any pages between them.
+    last = first + BufferPool::READ_AHEAD - 1;
 
-    // Adds every item that isn't in v2 to
-    // ored. So, every item in v1 that isn't
-    // also in v2 has been added to ored.
-    for (int i = 0; i < v1.size(); i++)
+    if (!scanning)
     {
-        if (!tree.contains(v1[i]))
-            ored.push_back(v1[i]);
+        last = first;
+
+        for (std::size_t i = position; i < recnos.size() &&
+             Page::page_of(recnos[i]) < first + BufferPool::READ_AHEAD; i++)
+            last = Page::page_of(recnos[i]);
     }
 
-    // Adds the items in v2 to the ored.
-    // By doing this ored now contains
-    // every item which is in either v1 or
-    // v2 without any duplicates
-    ored += v2;
+    buffer_pool.prefetch(table->file_id, first, last - first + 1);
+    read_ahead = last;
+}
 
-    return ored;
-}                                               
-                                              
 // Needs testing
-jmiller::Vector<std::size_t> Table::get_conditional_indices(const Vectorstr& conditions) 
+RowSet Table::get_conditional_indices(const Vectorstr& conditions) 
 {
     Vectorstr rpn_conditions;
     Vectorstr simple_rpn;
-    jmiller::Vector<std::size_t> v1;
-    jmiller::Vector<std::size_t> v2;
-    Stack<jmiller::Vector<std::size_t> > vstack;
+    RowSet v1;
+    RowSet v2;
+    Stack<RowSet> vstack;
     rpn_conditions = get_rpn(conditions);
 
     for (int i = 0; i < rpn_conditions.size(); i++)
@@ -358,13 +2478,13 @@ jmiller::Vector<std::size_t> Table::get_conditional_indices(const Vectorstr& con
             {
                 v1 = vstack.pop();
                 v2 = vstack.pop();
-                vstack.push(and_vector(v1, v2));
+                vstack.push(v1 & v2);
             }
             else if (rpn_conditions[i] == "or")
             {
                 v1 = vstack.pop();
                 v2 = vstack.pop();
-                vstack.push(or_vector(v1, v2));
+                vstack.push(v1 | v2);
             }
             else
             {
@@ -386,52 +2506,272 @@ jmiller::Vector<std::size_t> Table::get_conditional_indices(const Vectorstr& con
         }
     }  
 
-    if (!vstack.is_empty())
-        return vstack.pop();
-    else
-        return jmiller::Vector<std::size_t>();
-      
+    // The sets on the stack are in rid order, so the
+    // records are read from the front of the table to the
+    // back rather than jumping around
+    if (vstack.is_empty())
+        return RowSet();
+
+    return vstack.pop();
 }
 
-jmiller::Vector<std::size_t> Table::get_simple_indices(Vectorstr& s_conditions)
+RowSet Table::get_simple_indices(Vectorstr& s_conditions)
 {
-    jmiller::Vector<std::size_t> row_indices;
+    RowSet row_indices;
+    const RowSet* postings;
+    jmiller::Vector<std::size_t> recnos;
+    index_iter first;
+    index_iter last;
+    Value key;
+
+    if (!field_indices.contains(s_conditions[0]))
+    {
+        std::cout << "Unknown field " << s_conditions[0] << "." << std::endl;
+        return row_indices;
+    }
+
+    if (field_types[field_indices[s_conditions[0]]].type == FieldType::DICT)
+        return get_dictionary_indices(s_conditions);
+
+    // The value in the condition is read as the field's
+    // type so it compares the same way the index keys do
+    if (!Value::parse(field_types[field_indices[s_conditions[0]]], s_conditions[1], key))
+    {
+        std::cout << "\"" << s_conditions[1] << "\" is not a valid "
+                  << field_types[field_indices[s_conditions[0]]].name()
+                  << " for " << s_conditions[0] << "." << std::endl;
+        return row_indices;
+    }
+
+    // The catalog's range of the field rules out conditions
+    // no record can meet without loading the index
+    if (!info->columns[field_indices[s_conditions[0]]].may_match(key, s_conditions[2]))
+        return row_indices;
+
+    if (!has_index(field_indices[s_conditions[0]]))
+        return scan_condition(field_indices[s_conditions[0]], key, s_conditions[2]);
+
+    load_index(s_conditions[0]);
+
+    ColumnIndex& index = indices[s_conditions[0]];
 
     if (s_conditions[2] == "=")
     {
-        if (indices[s_conditions[0]].contains(s_conditions[1]))
-        row_indices = indices[s_conditions[0]][s_conditions[1]];
+        postings = index.find(key);
+
+        if (postings != NULL)
+            row_indices = *postings;
+
+        return row_indices;
     }
-    else if (s_conditions[2] == ">")
+
+    if (s_conditions[2] == ">")
     {
-        mmap_iter it;
-        for (it = indices[s_conditions[0]].upper_bound(s_conditions[1]); 
-             it != indices[s_conditions[0]].end(); ++it)
-            row_indices += (*it).value_list;
+        first = index.upper_bound(key);
+        last = index.end();
     }
     else if (s_conditions[2] == ">=")
     {
-        mmap_iter it;
-        for (it = indices[s_conditions[0]].lower_bound(s_conditions[1]); 
-             it != indices[s_conditions[0]].end(); ++it)
-            row_indices += (*it).value_list;
+        first = index.lower_bound(key);
+        last = index.end();
     }
     else if (s_conditions[2] == "<")
     {
-        mmap_iter it;
-        for (it = indices[s_conditions[0]].begin(); 
-             it != indices[s_conditions[0]].lower_bound(s_conditions[1]); ++it)
-            row_indices += (*it).value_list;
+        first = index.begin();
+        last = index.lower_bound(key);
     }
     else if (s_conditions[2] == "<=")
     {
-        mmap_iter it;
-        for (it = indices[s_conditions[0]].begin(); 
-             it != indices[s_conditions[0]].upper_bound(s_conditions[1]); ++it)
-            row_indices += (*it).value_list;
+        first = index.begin();
+        last = index.upper_bound(key);
+    }
+    else if (s_conditions[2] == "!=")
+    {
+        // Every key but the one given
+        first = index.begin();
+        last = index.end();
     }
     else
+    {
         std::cout << "Invalid command got through in get_simple_indices()" << std::endl;
+        return row_indices;
+    }
+
+    for (index_iter it = first; it != last; ++it)
+    {
+        const Pair<Value, RowSet>& entry = *it;
+
+        if (s_conditions[2] != "!=" || entry.key != key)
+            add_postings(index, entry.value, row_indices, recnos);
+    }
+
+    if (recnos.size() > 0)
+        row_indices = RowSet(recnos);
+
+    return row_indices;
+}
+
+void Table::add_postings(const ColumnIndex& index, const RowSet& postings,
+                         RowSet& rows, jmiller::Vector<std::size_t>& recnos)
+{
+    // A bitmap index has few values with many records each,
+    // so their sets are ORed together whole.  The keys of a
+    // tree usually have a few records each, which are
+    // gathered and put in one set at the end rather than
+    // ORed in one key at a time.
+    if (index.kind() == ColumnIndex::BITMAP)
+        rows |= postings;
+    else
+        recnos += postings.rows();
+}
+
+RowSet Table::scan_condition(std::size_t col, const Value& key, const std::string& op)
+{
+    jmiller::Vector<std::size_t> recnos;
+    jmiller::Vector<std::size_t> matches;
+    jmiller::Vector<std::size_t> cols;
+    jmiller::Vector<Value> values;
+    Value value;
+
+    cols.push_back(col);
+    recnos = all_recnos();
+
+    // A field without an index is answered by reading its
+    // value from every record, so a columnar table only
+    // reads the one column.  A dict field's codes aren't
+    // in string order so its strings are compared.
+    for (int i = 0; i < recnos.size(); i++)
+    {
+        values = read_values(recnos[i], cols);
+
+        if (values.size() == 0)
+            continue;
+
+        value = values[0];
+
+        if (dictionaries[col] != NULL)
+            Value::parse(FieldType(), value_text(col, value), value);
+
+        if (meets(value, op, key))
+            matches.push_back(recnos[i]);
+    }
+
+    return RowSet(matches);
+}
+
+bool Table::meets(const Value& value, const std::string& op, const Value& key)
+{
+    if (op == "=")
+        return value == key;
+    else if (op == "!=")
+        return value != key;
+    else if (op == "<")
+        return value < key;
+    else if (op == "<=")
+        return value <= key;
+    else if (op == ">")
+        return value > key;
+    else if (op == ">=")
+        return value >= key;
+
+    return false;
+}
+
+RowSet Table::get_dictionary_indices(Vectorstr& s_conditions)
+{
+    RowSet row_indices;
+    const RowSet* postings;
+    jmiller::Vector<std::size_t> recnos;
+    Dictionary* dictionary;
+    Dictionary::Iterator first;
+    Dictionary::Iterator last;
+    uint32_t code;
+    std::size_t col;
+    Value key;
+
+    col = field_indices[s_conditions[0]];
+    dictionary = dictionaries[col];
+
+    // The range of a dict field is kept as strings
+    Value::parse(FieldType(), s_conditions[1], key);
+
+    if (!info->columns[col].may_match(key, s_conditions[2]))
+        return row_indices;
+
+    if (!has_index(col))
+        return scan_condition(col, key, s_conditions[2]);
+
+    load_index(s_conditions[0]);
+
+    ColumnIndex& index = indices[s_conditions[0]];
+
+    // An equality is turned into a single code.  A string
+    // which isn't in the dictionary isn't in any record.
+    if (s_conditions[2] == "=")
+    {
+        if (dictionary->find(s_conditions[1], code))
+        {
+            key = Value::decode(field_types[col], (const char*)&code, sizeof(code));
+
+            postings = index.find(key);
+
+            if (postings != NULL)
+                row_indices = *postings;
+        }
+
+        return row_indices;
+    }
+
+    // A range is found among the strings of the dictionary,
+    // which are kept in order, and the records of each code
+    // in it are taken from the index
+    if (s_conditions[2] == ">")
+    {
+        first = dictionary->upper_bound(s_conditions[1]);
+        last = dictionary->end();
+    }
+    else if (s_conditions[2] == ">=")
+    {
+        first = dictionary->lower_bound(s_conditions[1]);
+        last = dictionary->end();
+    }
+    else if (s_conditions[2] == "<")
+    {
+        first = dictionary->begin();
+        last = dictionary->lower_bound(s_conditions[1]);
+    }
+    else if (s_conditions[2] == "<=")
+    {
+        first = dictionary->begin();
+        last = dictionary->upper_bound(s_conditions[1]);
+    }
+    else if (s_conditions[2] == "!=")
+    {
+        first = dictionary->begin();
+        last = dictionary->end();
+    }
+    else
+    {
+        std::cout << "Invalid command got through in get_dictionary_indices()" << std::endl;
+        return row_indices;
+    }
+
+    for (Dictionary::Iterator it = first; it != last; ++it)
+    {
+        if (s_conditions[2] == "!=" && (*it).key == s_conditions[1])
+            continue;
+
+        code = (*it).value;
+        key = Value::decode(field_types[col], (const char*)&code, sizeof(code));
+
+        postings = index.find(key);
+
+        if (postings != NULL)
+            add_postings(index, *postings, row_indices, recnos);
+    }
+
+    if (recnos.size() > 0)
+        row_indices = RowSet(recnos);
 
     return row_indices;
 }
@@ -468,9 +2808,9 @@ void Table::set_prec()
 {
     // Creates a map mapping operator strings to their
     // precedence
-    std::string strings[6] = { "=", "<", ">", "<=", ">=" };
+    std::string strings[6] = { "=", "<", ">", "<=", ">=", "!=" };
 
-    for (int i = 0; i < 5; i++)
+    for (int i = 0; i < 6; i++)
         precedence.insert(strings[i], 5);
 
     precedence.insert("and", 3);
@@ -12,7 +12,24 @@
  
  A set of array functions used by several classes in this
  project
- 
+
+ first_ge() is the search within a node of a BPTree or
+ BTree.  It's a binary search without branches on the
+ comparisons, except for integer items, whose items less
+ than the entry are counted in one pass the compiler can do
+ a few at a time with vector instructions.  The integer
+ types are named by is_integer_item.
+
+ The functions which move items along an array copy the
+ bytes with memmove when the items are relocatable, which
+ is_relocatable says of every trivially copyable type, such
+ as a node's child pointers.  Other items, like index keys
+ which hold a string and a RowSet, are moved one at a time
+ with std::move, so their memory is handed over rather than
+ copied.  copy_array() leaves its source as it was and
+ copies them instead.  A type can be added to either trait
+ by specializing it.
+
 */
 
 #ifndef ARRAY_FUNCTIONS_H
@@ -20,8 +37,120 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <type_traits>
 #include <assert.h>
 
+// Items which can be moved by copying their bytes
+template <class Item> struct is_relocatable
+{
+    static const bool value = std::is_trivially_copyable<Item>::value;
+};
+
+// Items searched by counting rather than by halves
+template <class Item> struct is_integer_item
+{
+    static const bool value = std::is_integral<Item>::value;
+};
+
+// The kernels picked by the traits above.  The bool
+// is the trait's value, so the choice is made when the
+// template is compiled.
+template <bool by_count>
+struct NodeSearch
+{
+    template <class Item>
+    static int first_ge(const Item data[ ], int n, const Item& entry)
+    {
+        const Item* base;
+        int half;
+
+        if (n == 0)
+            return 0;
+
+        // Halves the range each step.  The new base is picked
+        // rather than branched to, so a compiler can use a
+        // conditional move and the steps don't mispredict.
+        base = data;
+
+        while (n > 1)
+        {
+            half = n / 2;
+            base = (base[half - 1] < entry) ? base + half : base;
+            n -= half;
+        }
+
+        return (base - data) + (*base < entry);
+    }
+};
+
+template <>
+struct NodeSearch<true>
+{
+    template <class Item>
+    static int first_ge(const Item data[ ], int n, const Item& entry)
+    {
+        int count;
+
+        // The items are in order, so the number less than
+        // entry is the index of the first one which isn't
+        count = 0;
+
+        for (int i = 0; i < n; i++)
+            count += data[i] < entry;
+
+        return count;
+    }
+};
+
+template <bool relocatable>
+struct ItemMover
+{
+    // Moves n items from src to dest, which may overlap
+    template <class Item>
+    static void move(Item dest[ ], Item src[ ], int n)
+    {
+        if (dest < src)
+            for (int i = 0; i < n; i++)
+                dest[i] = std::move(src[i]);
+        else
+            for (int i = n - 1; i >= 0; i--)
+                dest[i] = std::move(src[i]);
+    }
+
+    // Copies n items from src to dest, which don't overlap
+    template <class Item>
+    static void copy(Item dest[ ], const Item src[ ], int n)
+    {
+        for (int i = 0; i < n; i++)
+            dest[i] = src[i];
+    }
+};
+
+template <>
+struct ItemMover<true>
+{
+    template <class Item>
+    static void move(Item dest[ ], const Item src[ ], int n)
+    {
+        if (n > 0)
+            memmove(dest, src, n * sizeof(Item));
+    }
+
+    template <class Item>
+    static void copy(Item dest[ ], const Item src[ ], int n)
+    {
+        move(dest, src, n);
+    }
+};
+
+template <class Item>
+void move_items(Item dest[ ], Item src[ ], int n)
+{
+    ItemMover<is_relocatable<Item>::value>::move(dest, src, n);
+}
+
 
 template <class Item>
 Item maximal(const Item& a, const Item& b)
@@ -60,16 +189,7 @@ int index_of_maximal(Item data[ ], int n)
 template <class Item>
 int first_ge(const Item data[ ], int n, const Item& entry) 
 {
-    int index;
-    index = 0;
-
-    while (index < n)
-    {
-        if (data[index] >= entry)
-            return index;
-        index++;
-    }
-    return index;
+    return NodeSearch<is_integer_item<Item>::value>::first_ge(data, n, entry);
 }   
 
 template <class Item>
@@ -77,10 +197,9 @@ void insert_item(Item data[ ], int index, int& n, Item entry)
 {
     assert(index <= n);
 
-    for (int i = n; i > index; i--)
-        data[i] = data[i - 1];
+    move_items(data + index + 1, data + index, n - index);
 
-    data[index] = entry;
+    data[index] = std::move(entry);
     n++;
 }   
  
@@ -95,10 +214,9 @@ void delete_item(Item data[ ], int index, int& n, Item& entry)
 {
     assert(index < n);
 
-    entry = data[index];
+    entry = std::move(data[index]);
 
-    for (int i = index; i < n - 1; i++)
-        data[i] = data[i + 1];
+    move_items(data + index, data + index + 1, n - index - 1);
 
     n--;
 }   
@@ -106,9 +224,9 @@ void delete_item(Item data[ ], int index, int& n, Item& entry)
 template <class Item>
 void merge(Item data1[ ], int& n1, Item data2[ ], int& n2)
 {
-    for (int i = n2; i > 0; i--)
-        data1[n1++] = data2[n2 - i];
+    move_items(data1 + n1, data2, n2);
 
+    n1 += n2;
     n2 = 0;
 }   
 
@@ -118,11 +236,9 @@ void split(Item data1[ ], int& n1, Item data2[ ], int& n2)
     int mid = n1 / 2;
 
     if (n1 % 2 != 0)
-        for (int i = 0; i < mid; i++)
-            data2[i] = data1[mid + 1 + i];
+        move_items(data2, data1 + mid + 1, mid);
     else
-        for (int i = 0; i < mid; i++)
-            data2[i] = data1[mid + i];
+        move_items(data2, data1 + mid, mid);
 
     n1 = n2 = mid;
 }   
@@ -131,10 +247,15 @@ template <class Item>
 void copy_array(Item dest[], const Item src[],
                 int& dest_size, int src_size)
 {
-    for (int i = 0; i < src_size; i++)
-    {
-        dest[i] = src[i];
-    }
+    ItemMover<is_relocatable<Item>::value>::copy(dest, src, src_size);
+    dest_size = src_size;
+}        
+
+template <class Item>
+void move_array(Item dest[], Item src[],
+                int& dest_size, int src_size)
+{
+    move_items(dest, src, src_size);
     dest_size = src_size;
 }        
 
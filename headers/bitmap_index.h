@@ -0,0 +1,218 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: bitmap_index.h
+
+CLASS PROVIDED: BitmapIndex
+    The index of a column with few distinct values.  Each
+    value has a RowSet (see row_set.h) of the records which
+    hold it, and the values are kept in order in one array
+    rather than a tree.  Finding a value is a binary search
+    of that array, and a condition which takes many values,
+    like a range or a !=, ORs their bitmaps together.
+
+    A value is added in its place in the array, which moves
+    the values after it, so a column with many values should
+    be given the ordinary index instead.
+
+    BitmapIndex has the same functions as Map<Value, RowSet>
+    so either can be used behind a ColumnIndex.
+
+CONSTRUCTORS:
+    BitmapIndex()
+        Postcondition: An empty index has been created.
+
+ACCESSORS:
+    int size() const
+        Postcondition: The number of values has been returned.
+
+    bool empty() const
+        Postcondition: A bool indicating if the index has no values
+                       has been returned.
+
+    bool contains(const Value& key) const
+        Postcondition: A bool indicating if key has a bitmap has been
+                       returned.
+
+    RowSet* find(const Value& key)
+        Postcondition: The bitmap of key has been returned, or NULL if
+                       key has none.
+
+    Iterator begin()
+    Iterator end()
+    Iterator lower_bound(const Value& key)
+    Iterator upper_bound(const Value& key)
+        Postcondition: Iterators over the values in order.  Each item
+                       is a Pair of a value and its bitmap, given by
+                       reference so the bitmap isn't copied.
+
+MUTATORS:
+    RowSet& operator[](const Value& key)
+        Postcondition: The bitmap of key has been returned.  If key had
+                       none an empty one has been added.
+
+    void bulk_load(const jmiller::Vector<Pair<Value, RowSet> >& pairs)
+        Precondition: pairs is sorted by key with no key repeated.
+        Postcondition: The index holds exactly pairs.
+
+    void clear()
+        Postcondition: The index has no values.
+
+*/
+#ifndef BITMAP_INDEX_H
+#define BITMAP_INDEX_H
+
+#include <iostream>
+#include <cstdlib>
+#include "./map.h"
+#include "./row_set.h"
+#include "./value.h"
+#include "./vector.h"
+
+class BitmapIndex
+{
+public:
+    class Iterator
+    {
+    public:
+        friend class BitmapIndex;
+        Iterator(BitmapIndex* index = NULL, int at = 0) : _index(index), _at(at) {}
+
+        Iterator operator ++(int)
+        {
+            Iterator temp;
+            temp = *this;
+
+            ++(*this);
+            return temp;
+        }
+        Iterator operator ++()
+        {
+            _at++;
+            return *this;
+        }
+        const Pair<Value, RowSet>& operator *()
+        {
+            return _index->bitmaps[_at];
+        }
+        friend bool operator ==(const Iterator& lhs, const Iterator& rhs)
+        {
+            return lhs._index == rhs._index && lhs._at == rhs._at;
+        }
+        friend bool operator !=(const Iterator& lhs, const Iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+    private:
+        BitmapIndex* _index;
+        int _at;
+    };
+
+    // CONSTRUCTORS
+    BitmapIndex() {}
+
+    // ACCESSORS
+    int size() const { return bitmaps.size(); }
+    bool empty() const { return bitmaps.size() == 0; }
+    bool contains(const Value& key) const;
+    RowSet* find(const Value& key);
+
+    Iterator begin() { return Iterator(this, 0); }
+    Iterator end() { return Iterator(this, bitmaps.size()); }
+    Iterator lower_bound(const Value& key) { return Iterator(this, first_not_below(key)); }
+    Iterator upper_bound(const Value& key);
+
+    // MUTATORS
+    RowSet& operator[](const Value& key);
+    void bulk_load(const jmiller::Vector<Pair<Value, RowSet> >& pairs);
+    void clear() { bitmaps = jmiller::Vector<Pair<Value, RowSet> >(); }
+
+private:
+    jmiller::Vector<Pair<Value, RowSet> > bitmaps;
+
+    int first_not_below(const Value& key) const;
+};
+
+bool BitmapIndex::contains(const Value& key) const
+{
+    int at;
+
+    at = first_not_below(key);
+    return at < bitmaps.size() && bitmaps[at].key == key;
+}
+
+RowSet* BitmapIndex::find(const Value& key)
+{
+    int at;
+
+    at = first_not_below(key);
+    return (at < bitmaps.size() && bitmaps[at].key == key) ? &bitmaps[at].value : NULL;
+}
+
+BitmapIndex::Iterator BitmapIndex::upper_bound(const Value& key)
+{
+    int at;
+
+    at = first_not_below(key);
+
+    if (at < bitmaps.size() && bitmaps[at].key == key)
+        at++;
+
+    return Iterator(this, at);
+}
+
+RowSet& BitmapIndex::operator[](const Value& key)
+{
+    int at;
+
+    at = first_not_below(key);
+
+    if (at < bitmaps.size() && bitmaps[at].key == key)
+        return bitmaps[at].value;
+
+    // The new value is added to the end and
+    // moved down to its place
+    bitmaps.push_back(Pair<Value, RowSet>(key));
+
+    for (int i = bitmaps.size() - 1; i > at; i--)
+        bitmaps.swap(i, i - 1);
+
+    return bitmaps[at].value;
+}
+
+void BitmapIndex::bulk_load(const jmiller::Vector<Pair<Value, RowSet> >& pairs)
+{
+    bitmaps = pairs;
+}
+
+int BitmapIndex::first_not_below(const Value& key) const
+{
+    int low;
+    int high;
+    int mid;
+
+    low = 0;
+    high = bitmaps.size();
+
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+
+        if (bitmaps[mid].key < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+#endif
@@ -0,0 +1,634 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: buffer_pool.h
+
+CLASS PROVIDED: BufferPool
+    A cache of table file pages held in a fixed number of
+    frames.  Every page of every table is read and written
+    through the pool, so pages which are used often stay in
+    memory between statements instead of being read from the
+    file each time.
+
+    A page is pinned while it is being used and can't be
+    evicted until it has been unpinned.  When a frame is
+    needed the CLOCK algorithm picks an unpinned page which
+    hasn't been used recently.  Pages which were changed
+    are written back to their file when they are evicted or
+    flushed.
+
+    Pages which are only going to be read can be taken with
+    read() instead of fetch().  When mapped reads are on and
+    every change to the file has been written back, read()
+    returns the page straight out of a memory mapping of the
+    file (see mapped_file.h) without using a frame, a seek or
+    a copy.  A file with changed pages which haven't been
+    written back yet, such as one being appended to, is read
+    through the frames instead.
+
+    A page is never written back ahead of the log records of
+    its changes.  The write back hook is called with the
+    file's name before each changed page is written, which
+    the LogManager (see wal.h) uses to force the file's log
+    to disk first.
+
+VALUE SEMANTICS:
+    The pool owns open files and frames so it can't be copied.
+
+CONSTRUCTORS:
+    BufferPool(int frame_count = DEFAULT_FRAMES)
+        Postcondition: An empty pool with frame_count frames has
+                       been created.
+
+FILE FUNCTIONS:
+    int open_file(const std::string& file_name, bool truncate = false)
+        Postcondition: The file has been opened by the pool and its id
+                       returned.  A file which is already open keeps its
+                       id and cached pages.  If truncate is true the file
+                       is emptied and its cached pages are dropped.
+                       Returns -1 if the file can't be opened.
+
+    long page_count(int file) const
+        Postcondition: The number of pages in the file, counting pages
+                       which haven't been written back yet, has been
+                       returned.
+
+PAGE FUNCTIONS:
+    Page* fetch(int file, long page_no)
+        Postcondition: The page has been pinned and a pointer to it
+                       returned.  Returns NULL if the file has no such
+                       page or every frame is pinned.
+
+    Page* new_page(int file, long& page_no)
+        Postcondition: An empty page has been added to the end of the
+                       file, pinned and returned.  page_no holds its
+                       page number.
+
+    void unpin(int file, long page_no, bool dirty)
+        Precondition: The page was pinned by fetch() or new_page().
+        Postcondition: The pin has been released.  If dirty is true
+                       the page will be written back to its file.
+
+    const Page* read(int file, long page_no)
+        Postcondition: A page which may only be read has been returned.
+                       It must be given back with release().  Returns
+                       NULL if the file has no such page.
+
+    void release(int file, long page_no, const Page* page)
+        Precondition: page was returned by read(file, page_no).
+        Postcondition: The page is no longer in use.
+
+    void prefetch(int file, long page_no, int count)
+        Postcondition: The count pages from page_no on which weren't in
+                       the pool have been read into frames, each run of
+                       pages next to each other in a single read, so
+                       they're there when they're read.  Pages of a
+                       mapped file are asked for from the operating
+                       system instead.  No page is pinned.
+
+    void append_pages(int file, const Page* pages, int count)
+        Postcondition: count pages have been written straight to the end
+                       of the file in a single write without going
+                       through the frames.  Used to load many records
+                       at once.
+
+    void flush(int file)
+    void flush_all()
+        Postcondition: Every changed page of the file (or of every file)
+                       has been written back.  The pages stay cached.
+
+    void set_mapped_reads(bool on)
+        Postcondition: read() uses memory mapped files if on is true,
+                       and only the frames otherwise.
+
+    void set_write_back_hook(WriteBackHook hook, void* owner)
+        Postcondition: hook is called with owner and the name of the
+                       file before a changed page is written back to
+                       it.  A NULL hook is never called.
+
+*/
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "./page.h"
+#include "./mapped_file.h"
+#include "./map.h"
+#include "./vector.h"
+
+// Called with its owner and a file's name before a
+// changed page is written back to the file
+typedef void (*WriteBackHook)(void* owner, const std::string& file_name);
+
+class BufferPool
+{
+public:
+    // STATIC MEMBER CONSTANTS
+    static const int DEFAULT_FRAMES = 1024;
+    static const int READ_AHEAD = 16;
+
+    // CONSTRUCTORS
+    BufferPool(int frame_count = DEFAULT_FRAMES);
+
+    // DESTRUCTOR
+    ~BufferPool();
+
+    // FILE FUNCTIONS
+    int open_file(const std::string& file_name, bool truncate = false);
+    long page_count(int file) const { return files[file]->page_count; }
+
+    // PAGE FUNCTIONS
+    Page* fetch(int file, long page_no);
+    Page* new_page(int file, long& page_no);
+    void unpin(int file, long page_no, bool dirty);
+    const Page* read(int file, long page_no);
+    void release(int file, long page_no, const Page* page);
+    void prefetch(int file, long page_no, int count);
+    void append_pages(int file, const Page* pages, int count);
+    void flush(int file);
+    void flush_all();
+    void set_mapped_reads(bool on) { mapped_reads = on; }
+    void set_write_back_hook(WriteBackHook hook, void* owner);
+
+private:
+    struct Frame
+    {
+        Page page;
+        int file;
+        long page_no;
+        int pin_count;
+        bool dirty;
+        bool referenced;
+    };
+
+    struct File
+    {
+        std::string name;
+        std::fstream fs;
+        long page_count;
+
+        // The frame holding each page of the file or -1
+        // if the page isn't in the pool.
+        jmiller::Vector<int> resident;
+
+        // The number of pages in frames which have changes
+        // that haven't been written back to the file.
+        int dirty_pages;
+
+        // A read only mapping of the file used by read()
+        // and the number of its pages which are in use.
+        MappedFile mapped;
+        int mapped_readers;
+    };
+
+    Frame* frames;
+    int frame_count;
+    int clock_hand;
+    bool mapped_reads;
+    WriteBackHook write_back_hook;
+    void* hook_owner;
+    jmiller::Vector<File*> files;
+    Map<std::string, int> file_ids;
+
+    // The pool can't be copied
+    BufferPool(const BufferPool& other);
+    BufferPool& operator =(const BufferPool& rhs);
+
+    int find_frame(int file, long page_no);
+    const char* mapped_page(int file, long page_no);
+    int get_victim();
+    void load_frame(int frame, int file, long page_no);
+    void write_back(int frame);
+};
+
+BufferPool::BufferPool(int count)
+{
+    frame_count = count;
+    clock_hand = 0;
+    mapped_reads = true;
+    write_back_hook = NULL;
+    hook_owner = NULL;
+    frames = new Frame[frame_count];
+
+    for (int i = 0; i < frame_count; i++)
+    {
+        frames[i].file = -1;
+        frames[i].page_no = -1;
+        frames[i].pin_count = 0;
+        frames[i].dirty = false;
+        frames[i].referenced = false;
+    }
+}
+
+BufferPool::~BufferPool()
+{
+    flush_all();
+
+    for (int i = 0; i < files.size(); i++)
+        delete files[i];
+
+    delete[] frames;
+}
+
+int BufferPool::open_file(const std::string& file_name, bool truncate)
+{
+    File* f;
+    int id;
+
+    if (file_ids.contains(file_name))
+    {
+        id = file_ids[file_name];
+        f = files[id];
+
+        if (!truncate)
+            return id;
+
+        // Drops every cached page of the file without
+        // writing it back since the file is being emptied.
+        for (int i = 0; i < frame_count; i++)
+            if (frames[i].file == id)
+            {
+                frames[i].file = -1;
+                frames[i].page_no = -1;
+                frames[i].pin_count = 0;
+                frames[i].dirty = false;
+                frames[i].referenced = false;
+            }
+
+        f->resident.clear();
+        f->mapped.close();
+        f->mapped_readers = 0;
+        f->fs.close();
+    }
+    else
+    {
+        f = new File;
+        f->name = file_name;
+        id = files.size();
+    }
+
+    if (truncate)
+    {
+        // Creates the file if it doesn't exist
+        f->fs.open(file_name.c_str(), std::fstream::out | std::fstream::binary | std::fstream::trunc);
+        f->fs.close();
+    }
+
+    f->fs.clear();
+    f->fs.open(file_name.c_str(), std::fstream::in | std::fstream::out | std::fstream::binary);
+
+    if (f->fs.fail() && id == files.size())
+    {
+        delete f;
+        return -1;
+    }
+
+    f->page_count = Page::count(f->fs);
+    f->dirty_pages = 0;
+    f->mapped_readers = 0;
+
+    if (id == files.size())
+    {
+        files.push_back(f);
+        file_ids.insert(file_name, id);
+    }
+
+    return id;
+}
+
+Page* BufferPool::fetch(int file, long page_no)
+{
+    int frame;
+
+    if (file < 0 || page_no < 0 || page_no >= files[file]->page_count)
+        return NULL;
+
+    frame = find_frame(file, page_no);
+
+    if (frame < 0)
+    {
+        frame = get_victim();
+
+        if (frame < 0)
+        {
+            std::cout << "Every page in the buffer pool is pinned." << std::endl;
+            return NULL;
+        }
+
+        load_frame(frame, file, page_no);
+        frames[frame].page.read(files[file]->fs, page_no);
+    }
+
+    frames[frame].pin_count++;
+    frames[frame].referenced = true;
+
+    return &frames[frame].page;
+}
+
+Page* BufferPool::new_page(int file, long& page_no)
+{
+    int frame;
+
+    frame = get_victim();
+
+    if (frame < 0)
+    {
+        std::cout << "Every page in the buffer pool is pinned." << std::endl;
+        return NULL;
+    }
+
+    page_no = files[file]->page_count++;
+
+    load_frame(frame, file, page_no);
+    frames[frame].page = Page();
+    frames[frame].pin_count = 1;
+    frames[frame].referenced = true;
+    frames[frame].dirty = true;
+    files[file]->dirty_pages++;
+
+    return &frames[frame].page;
+}
+
+void BufferPool::unpin(int file, long page_no, bool dirty)
+{
+    int frame;
+    frame = find_frame(file, page_no);
+
+    assert(frame >= 0 && frames[frame].pin_count > 0);
+
+    frames[frame].pin_count--;
+
+    if (dirty && !frames[frame].dirty)
+    {
+        frames[frame].dirty = true;
+        files[file]->dirty_pages++;
+    }
+}
+
+const Page* BufferPool::read(int file, long page_no)
+{
+    const char* mapped;
+
+    if (file < 0 || page_no < 0 || page_no >= files[file]->page_count)
+        return NULL;
+
+    mapped = mapped_page(file, page_no);
+
+    if (mapped != NULL)
+    {
+        files[file]->mapped_readers++;
+        return Page::at(mapped);
+    }
+
+    return fetch(file, page_no);
+}
+
+void BufferPool::release(int file, long page_no, const Page* page)
+{
+    File* f;
+    const char* data;
+    f = files[file];
+    data = (const char*)page;
+
+    // Pages which came from the mapping were never pinned
+    if (f->mapped.is_open() && data >= f->mapped.data() &&
+        data < f->mapped.data() + f->mapped.size())
+        f->mapped_readers--;
+    else
+        unpin(file, page_no, false);
+}
+
+void BufferPool::prefetch(int file, long page_no, int count)
+{
+    File* f;
+    char* run;
+    long first;
+    long end;
+    int frame;
+
+    if (file < 0 || page_no < 0)
+        return;
+
+    f = files[file];
+
+    // No more pages are read ahead than a quarter of the
+    // pool so the pages being used aren't pushed out
+    if (count > frame_count / 4)
+        count = frame_count / 4;
+
+    if (page_no + count > f->page_count)
+        count = f->page_count - page_no;
+
+    if (count <= 0)
+        return;
+
+    // The operating system reads the pages of a mapping
+    if (mapped_page(file, page_no) != NULL)
+    {
+        f->mapped.will_need(page_no * Page::SIZE, (long)count * Page::SIZE);
+        return;
+    }
+
+    run = new char[(long)count * Page::SIZE];
+    first = page_no;
+
+    while (first < page_no + count)
+    {
+        // Finds the next run of pages which aren't in frames
+        while (first < page_no + count && find_frame(file, first) >= 0)
+            first++;
+
+        end = first;
+
+        while (end < page_no + count && find_frame(file, end) < 0)
+            end++;
+
+        if (first == end)
+            break;
+
+        f->fs.clear();
+        f->fs.seekg(first * Page::SIZE, std::ios_base::beg);
+        f->fs.read(run, (end - first) * Page::SIZE);
+
+        // Pages are only made of their bytes so each
+        // one is copied into a frame of its own
+        for (long i = first; i < end; i++)
+        {
+            frame = get_victim();
+
+            if (frame < 0)
+            {
+                delete[] run;
+                return;
+            }
+
+            load_frame(frame, file, i);
+            memcpy((char*)&frames[frame].page, run + (i - first) * Page::SIZE, Page::SIZE);
+            frames[frame].referenced = true;
+        }
+
+        first = end;
+    }
+
+    delete[] run;
+}
+
+void BufferPool::append_pages(int file, const Page* pages, int count)
+{
+    File* f;
+    f = files[file];
+
+    // Pages are only made of their bytes so an array
+    // of them can be written as one block
+    f->fs.clear();
+    f->fs.seekp(f->page_count * Page::SIZE, std::ios_base::beg);
+    f->fs.write((const char*)pages, (std::streamsize)count * Page::SIZE);
+    f->fs.flush();
+
+    f->page_count += count;
+}
+
+void BufferPool::set_write_back_hook(WriteBackHook hook, void* owner)
+{
+    write_back_hook = hook;
+    hook_owner = owner;
+}
+
+void BufferPool::flush(int file)
+{
+    if (files[file]->dirty_pages == 0)
+        return;
+
+    for (int i = 0; i < frame_count; i++)
+        if (frames[i].file == file && frames[i].dirty)
+            write_back(i);
+}
+
+void BufferPool::flush_all()
+{
+    for (int i = 0; i < files.size(); i++)
+        flush(i);
+}
+
+int BufferPool::find_frame(int file, long page_no)
+{
+    jmiller::Vector<int>& resident = files[file]->resident;
+
+    if (page_no < resident.size())
+        return resident[page_no];
+
+    return -1;
+}
+
+const char* BufferPool::mapped_page(int file, long page_no)
+{
+    File* f;
+    f = files[file];
+
+    if (!mapped_reads || f->dirty_pages > 0)
+        return NULL;
+
+    // The mapping is made the first time it's needed and
+    // made again once the file has grown past it, as long as
+    // none of the pages of the old mapping are still in use.
+    if (f->mapped.size() < (page_no + 1) * Page::SIZE)
+    {
+        if (f->mapped_readers > 0)
+            return NULL;
+
+        f->fs.flush();
+
+        if (!f->mapped.open(f->name) || f->mapped.size() < (page_no + 1) * Page::SIZE)
+            return NULL;
+    }
+
+    return f->mapped.data() + page_no * Page::SIZE;
+}
+
+int BufferPool::get_victim()
+{
+    // Goes around the frames clearing the referenced bit of
+    // each unpinned frame until one is found which hasn't been
+    // referenced since the last time the hand passed it.
+    // Two full turns are enough to find one if any frame is
+    // unpinned.
+    for (int i = 0; i < 2 * frame_count; i++)
+    {
+        Frame& frame = frames[clock_hand];
+        int victim = clock_hand;
+
+        clock_hand = (clock_hand + 1) % frame_count;
+
+        if (frame.pin_count > 0)
+            continue;
+
+        if (frame.referenced)
+        {
+            frame.referenced = false;
+            continue;
+        }
+
+        if (frame.file >= 0)
+        {
+            if (frame.dirty)
+                write_back(victim);
+
+            files[frame.file]->resident[frame.page_no] = -1;
+        }
+
+        frame.file = -1;
+        frame.page_no = -1;
+        return victim;
+    }
+
+    return -1;
+}
+
+void BufferPool::load_frame(int frame, int file, long page_no)
+{
+    jmiller::Vector<int>& resident = files[file]->resident;
+
+    while (resident.size() <= page_no)
+        resident.push_back(-1);
+
+    resident[page_no] = frame;
+
+    frames[frame].file = file;
+    frames[frame].page_no = page_no;
+    frames[frame].pin_count = 0;
+    frames[frame].dirty = false;
+}
+
+void BufferPool::write_back(int frame)
+{
+    File* f;
+    f = files[frames[frame].file];
+
+    // The changes to the page are logged before the
+    // page is written, so the file never holds a change
+    // which recovery doesn't know to undo
+    if (write_back_hook != NULL)
+        write_back_hook(hook_owner, f->name);
+
+    // The stream is flushed so a mapping of the
+    // file sees the page straight away
+    frames[frame].page.write(f->fs, frames[frame].page_no);
+    f->fs.flush();
+
+    frames[frame].dirty = false;
+    f->dirty_pages--;
+}
+
+#endif
@@ -0,0 +1,515 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: catalog.h
+
+CLASSES PROVIDED:
+    ColumnInfo:
+        What the catalog knows about a field: its name, its
+        type, where its index file is, what kind of index it
+        has (see column_index.h), or "none" if it has none,
+        and the smallest and largest value it holds.  The range only ever grows,
+        so a condition outside it can't match any record.
+
+    TableInfo:
+        What the catalog knows about a table: its fields, the
+        layout version it was made with, how it's stored, how
+        many records it has and which of its pages have the
+        slot of a deleted record to give to a new one.
+
+    Catalog:
+        The TableInfo of every table in the database, read
+        from one file when the program starts so a table can
+        be opened without reading or scanning its files.
+
+        Tables change the TableInfo as records are added, and
+        the catalog file is written each time a table is
+        checkpointed (see wal.h).  The file then holds each
+        table as it was at its last checkpoint, which is when
+        the table's pages are on disk and its log is empty.
+        Each checkpoint is numbered with an epoch which is
+        kept in the catalog and written at the start of the
+        table's log, so recovery knows if the records in the
+        log come after the catalog's count.
+
+FILE FORMAT:
+    header:  ["RDMSCAT" : 8 bytes][format : 4 bytes][tables : 4 bytes]
+    tables:  [strings : 4 bytes]([length : 4 bytes][string])...
+
+    Each table is a list of strings holding its name, table
+    file, layout version, storage, record count, epoch and
+    number of fields, then for each field its name, type,
+    index file, range and index kind, then the page numbers
+    with free slots separated by spaces.  Format 1 files have
+    no index kinds and every field has the tree index.  A list without the last
+    string has no free slots.  The file is written to a copy
+    which is renamed over the old one, so it's never left
+    half written.
+
+ColumnInfo:
+    void widen(const Value& value)
+        Postcondition: The range holds value.
+
+    bool may_match(const Value& key, const std::string& op) const
+        Postcondition: Returns false if no value in the range is op key.
+
+    static FieldType range_type(const FieldType& type)
+        Postcondition: The type the range of a field of type is kept
+                       in has been returned.  A dict field's range is
+                       kept as strings.
+
+Catalog:
+    Catalog()
+        Postcondition: An empty catalog has been created.
+
+    bool loaded() const
+        Postcondition: A bool indicating if load() has been called
+                       has been returned.
+
+    void load(const std::string& file_name)
+        Postcondition: The catalog has been read from file_name.  A
+                       missing file is an empty catalog.
+
+    TableInfo* find(const std::string& name)
+        Postcondition: The table's TableInfo has been returned, or NULL
+                       if the catalog doesn't have the table.
+
+    void add(TableInfo* info)
+        Postcondition: The catalog owns info, which has replaced any
+                       TableInfo of the same name.
+
+    uint64_t checkpoint(const std::string& table_file)
+        Postcondition: The catalog file holds the table as it is now and
+                       the table's new epoch has been returned.  Returns
+                       0 if the catalog doesn't have the table.
+
+*/
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdint.h>
+#include "./map.h"
+#include "./Record.h"
+#include "./value.h"
+#include "./vector.h"
+#include "./wal.h"
+
+struct ColumnInfo
+{
+    std::string name;
+    std::string type;
+    std::string index_file;
+    std::string index_kind;
+    bool has_range;
+    Value min;
+    Value max;
+
+    ColumnInfo() : index_kind("tree"), has_range(false) {}
+
+    void widen(const Value& value);
+    bool may_match(const Value& key, const std::string& op) const;
+    static FieldType range_type(const FieldType& type);
+};
+
+struct TableInfo
+{
+    // STATIC MEMBER CONSTANTS
+    // 1: untyped rows, 2: typed fields, 3: storage modes
+    static const int LAYOUT_VERSION = 3;
+
+    std::string name;
+    std::string table_file;
+    int version;
+    bool columnar;
+    uint64_t records;
+    uint64_t epoch;
+    jmiller::Vector<ColumnInfo> columns;
+    jmiller::Vector<uint64_t> free_pages;
+
+    TableInfo() : version(LAYOUT_VERSION), columnar(false), records(0), epoch(0) {}
+};
+
+class Catalog
+{
+public:
+    // CONSTRUCTORS
+    Catalog() : is_loaded(false) {}
+
+    // DESTRUCTOR
+    ~Catalog();
+
+    // ACCESSORS
+    bool loaded() const { return is_loaded; }
+    TableInfo* find(const std::string& name);
+
+    // MUTATORS
+    void load(const std::string& file_name);
+    void add(TableInfo* info);
+    uint64_t checkpoint(const std::string& table_file);
+
+private:
+    // 1: no index kinds, 2: index kinds
+    static const uint32_t FORMAT = 2;
+
+    std::string file_name;
+    bool is_loaded;
+
+    // The tables as they are now, and as they were at
+    // their last checkpoint, which is what's saved
+    Map<std::string, TableInfo*> current;
+    Map<std::string, TableInfo*> saved;
+
+    // A Catalog can't be copied
+    Catalog(const Catalog& other);
+    Catalog& operator =(const Catalog& rhs);
+
+    void save();
+    static void write_strings(FILE* file, const Vectorstr& strings);
+    static bool read_strings(FILE* file, Vectorstr& strings);
+    static Vectorstr to_strings(const TableInfo& info);
+    static bool from_strings(const Vectorstr& strings, TableInfo& info, uint32_t format);
+};
+
+void ColumnInfo::widen(const Value& value)
+{
+    if (!has_range)
+    {
+        min = value;
+        max = value;
+        has_range = true;
+    }
+    else if (value < min)
+        min = value;
+    else if (value > max)
+        max = value;
+}
+
+bool ColumnInfo::may_match(const Value& key, const std::string& op) const
+{
+    // A field without a range has no values
+    if (!has_range)
+        return false;
+
+    if (op == "=")
+        return key >= min && key <= max;
+    else if (op == ">")
+        return max > key;
+    else if (op == ">=")
+        return max >= key;
+    else if (op == "<")
+        return min < key;
+    else if (op == "<=")
+        return min <= key;
+    else if (op == "!=")
+        return !(min == key && max == key);
+
+    return true;
+}
+
+FieldType ColumnInfo::range_type(const FieldType& type)
+{
+    if (type.type == FieldType::DICT)
+        return FieldType();
+
+    return type;
+}
+
+Catalog::~Catalog()
+{
+    for (Map<std::string, TableInfo*>::Iterator it = current.begin(); it != current.end(); ++it)
+        delete (*it).value;
+
+    for (Map<std::string, TableInfo*>::Iterator it = saved.begin(); it != saved.end(); ++it)
+        delete (*it).value;
+}
+
+TableInfo* Catalog::find(const std::string& name)
+{
+    if (!current.contains(name))
+        return NULL;
+
+    return current[name];
+}
+
+void Catalog::load(const std::string& name)
+{
+    FILE* file;
+    char magic[8];
+    uint32_t format;
+    uint32_t count;
+    Vectorstr strings;
+    TableInfo* info;
+
+    file_name = name;
+    is_loaded = true;
+    file = fopen(file_name.c_str(), "rb");
+
+    if (file == NULL)
+        return;
+
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, "RDMSCAT", 8) != 0 ||
+        fread(&format, sizeof(format), 1, file) != 1 || format < 1 || format > FORMAT ||
+        fread(&count, sizeof(count), 1, file) != 1)
+    {
+        std::cout << file_name << " is not a catalog." << std::endl;
+        fclose(file);
+        return;
+    }
+
+    for (uint32_t i = 0; i < count && read_strings(file, strings); i++)
+    {
+        info = new TableInfo;
+
+        if (!from_strings(strings, *info, format))
+        {
+            delete info;
+            continue;
+        }
+
+        current.insert(info->name, info);
+        saved.insert(info->name, new TableInfo(*info));
+    }
+
+    fclose(file);
+}
+
+void Catalog::add(TableInfo* info)
+{
+    if (current.contains(info->name))
+        delete current[info->name];
+
+    current.insert(info->name, info);
+}
+
+uint64_t Catalog::checkpoint(const std::string& table_file)
+{
+    TableInfo* info;
+    info = NULL;
+
+    for (Map<std::string, TableInfo*>::Iterator it = current.begin(); it != current.end(); ++it)
+        if ((*it).value->table_file == table_file)
+            info = (*it).value;
+
+    if (info == NULL)
+        return 0;
+
+    info->epoch++;
+
+    if (saved.contains(info->name))
+        *saved[info->name] = *info;
+    else
+        saved.insert(info->name, new TableInfo(*info));
+
+    save();
+    return info->epoch;
+}
+
+void Catalog::save()
+{
+    FILE* file;
+    std::string temp_name;
+    uint32_t format;
+    uint32_t count;
+
+    temp_name = file_name + ".tmp";
+    file = fopen(temp_name.c_str(), "wb");
+
+    if (file == NULL)
+    {
+        std::cout << "Couldn't write " << temp_name << "." << std::endl;
+        return;
+    }
+
+    format = FORMAT;
+    count = 0;
+
+    for (Map<std::string, TableInfo*>::Iterator it = saved.begin(); it != saved.end(); ++it)
+        count++;
+
+    fwrite("RDMSCAT", 1, 8, file);
+    fwrite(&format, sizeof(format), 1, file);
+    fwrite(&count, sizeof(count), 1, file);
+
+    for (Map<std::string, TableInfo*>::Iterator it = saved.begin(); it != saved.end(); ++it)
+        write_strings(file, to_strings(*(*it).value));
+
+    // The copy is on disk before it replaces the
+    // catalog so one or the other is always whole
+    sync_file(file);
+    fclose(file);
+
+#ifdef _WIN32
+    remove(file_name.c_str());
+#endif
+    if (rename(temp_name.c_str(), file_name.c_str()) != 0)
+        std::cout << "Couldn't replace " << file_name << "." << std::endl;
+}
+
+void Catalog::write_strings(FILE* file, const Vectorstr& strings)
+{
+    uint32_t count;
+    uint32_t length;
+
+    count = strings.size();
+    fwrite(&count, sizeof(count), 1, file);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        length = strings[i].size();
+        fwrite(&length, sizeof(length), 1, file);
+        fwrite(strings[i].data(), 1, length, file);
+    }
+}
+
+bool Catalog::read_strings(FILE* file, Vectorstr& strings)
+{
+    uint32_t count;
+    uint32_t length;
+    std::string value;
+
+    strings.clear();
+
+    if (fread(&count, sizeof(count), 1, file) != 1)
+        return false;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (fread(&length, sizeof(length), 1, file) != 1)
+            return false;
+
+        value.resize(length);
+
+        if (length > 0 && fread(&value[0], 1, length, file) != length)
+            return false;
+
+        strings.push_back(value);
+    }
+
+    return true;
+}
+
+Vectorstr Catalog::to_strings(const TableInfo& info)
+{
+    Vectorstr strings;
+    FieldType type;
+    std::string pages;
+    char number[32];
+
+    strings.push_back(info.name);
+    strings.push_back(info.table_file);
+    sprintf(number, "%d", info.version);
+    strings.push_back(number);
+    strings.push_back(info.columnar ? "columnar" : "rows");
+    sprintf(number, "%llu", (unsigned long long)info.records);
+    strings.push_back(number);
+    sprintf(number, "%llu", (unsigned long long)info.epoch);
+    strings.push_back(number);
+    sprintf(number, "%d", (int)info.columns.size());
+    strings.push_back(number);
+
+    for (int i = 0; i < info.columns.size(); i++)
+    {
+        const ColumnInfo& column = info.columns[i];
+
+        FieldType::parse(column.type, type);
+        type = ColumnInfo::range_type(type);
+
+        strings.push_back(column.name);
+        strings.push_back(column.type);
+        strings.push_back(column.index_file);
+        strings.push_back(column.has_range ? "1" : "0");
+        strings.push_back(column.has_range ? column.min.encode(type) : "");
+        strings.push_back(column.has_range ? column.max.encode(type) : "");
+        strings.push_back(column.index_kind);
+    }
+
+    pages.clear();
+
+    for (int i = 0; i < info.free_pages.size(); i++)
+    {
+        sprintf(number, i == 0 ? "%llu" : " %llu", (unsigned long long)info.free_pages[i]);
+        pages += number;
+    }
+
+    strings.push_back(pages);
+    return strings;
+}
+
+bool Catalog::from_strings(const Vectorstr& strings, TableInfo& info, uint32_t format)
+{
+    ColumnInfo column;
+    FieldType type;
+    const char* pages;
+    char* end;
+    int fields;
+    int per_field;
+    int at;
+
+    if (strings.size() < 7)
+        return false;
+
+    info.name = strings[0];
+    info.table_file = strings[1];
+    info.version = atoi(strings[2].c_str());
+    info.columnar = strings[3] == "columnar";
+    info.records = strtoull(strings[4].c_str(), NULL, 10);
+    info.epoch = strtoull(strings[5].c_str(), NULL, 10);
+    fields = atoi(strings[6].c_str());
+    per_field = format == 1 ? 6 : 7;
+
+    if ((int)strings.size() != 7 + fields * per_field &&
+        (int)strings.size() != 8 + fields * per_field)
+        return false;
+
+    for (int i = 0; i < fields; i++)
+    {
+        at = 7 + i * per_field;
+
+        if (!FieldType::parse(strings[at + 1], type))
+            return false;
+
+        type = ColumnInfo::range_type(type);
+
+        column.name = strings[at];
+        column.type = strings[at + 1];
+        column.index_file = strings[at + 2];
+        column.has_range = strings[at + 3] == "1";
+
+        if (column.has_range)
+        {
+            column.min = Value::decode(type, strings[at + 4].data(), strings[at + 4].size());
+            column.max = Value::decode(type, strings[at + 5].data(), strings[at + 5].size());
+        }
+
+        column.index_kind = per_field > 6 ? strings[at + 6] : "tree";
+        info.columns.push_back(column);
+    }
+
+    if ((int)strings.size() == 8 + fields * per_field)
+    {
+        pages = strings[7 + fields * per_field].c_str();
+
+        for (uint64_t page = strtoull(pages, &end, 10); end != pages; page = strtoull(pages, &end, 10))
+        {
+            info.free_pages.push_back(page);
+            pages = end;
+        }
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,438 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: column_file.h
+
+CLASS PROVIDED: ColumnFile
+    The values of one field of a columnar table.  Values are
+    stored one after another in slotted pages (see page.h)
+    read and written through the BufferPool, so the pages of
+    a field only hold that field and reading a few fields of
+    a wide table doesn't read the others.
+
+    The n'th value of every column of a table belongs to the
+    same record, so a record is identified by its row id n.
+    Row ids start at 1.  Slot 0 of each page holds the row id
+    of the first value in it and the values follow in slots
+    1, 2, ...  A page written back after a crash without the
+    pages before it then still says which rows it holds.
+    The first row id in each page is kept in a directory
+    which is built from the pages the first time a row is
+    looked up.  Appending only needs the last page, so a
+    column which is only added to never builds it.
+
+VALUE SEMANTICS:
+    A ColumnFile only refers to a file opened by the pool
+    so it can be copied.
+
+CONSTRUCTORS:
+    ColumnFile()
+        Postcondition: A ColumnFile without a file has been created.
+
+    ColumnFile(BufferPool* pool, const std::string& file_name, bool create = false)
+        Postcondition: The file has been opened through pool.  If create
+                       is true it has been created or emptied.
+
+ACCESSORS:
+    bool is_open() const
+        Postcondition: A bool indicating if the file is open has been
+                       returned.
+
+    long row_count() const
+        Postcondition: The number of values in the column has been
+                       returned.
+
+    bool get(long row, std::string& value) const
+        Postcondition: value holds the bytes stored for row.  Returns
+                       false if the column has no such row.
+
+MUTATORS:
+    long append(const char* data, int length)
+        Postcondition: The value has been added after the last row and
+                       its row id returned.  Returns 0 if it couldn't be
+                       written.
+
+    bool redo(long row, const char* data, int length)
+        Postcondition: If row is the row after the last one the value
+                       has been appended and true returned.
+
+    bool update(long row, const char* data, int length)
+        Postcondition: The value of row has been replaced.  Returns
+                       false and leaves it alone if the new value
+                       doesn't fit in the row's page.
+
+    bool erase(long row)
+        Postcondition: row has no value until it's given one by
+                       update().  Used to make room in its page when
+                       a log is replayed.
+
+    void truncate(long rows)
+        Postcondition: Only the first rows values are left in the column.
+
+*/
+#ifndef COLUMN_FILE_H
+#define COLUMN_FILE_H
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdint.h>
+#include "./page.h"
+#include "./buffer_pool.h"
+#include "./vector.h"
+
+class ColumnFile
+{
+public:
+    // STATIC MEMBER CONSTANTS
+    static const int MAX_VALUE = Page::MAX_RECORD - Page::SLOT_SIZE - sizeof(uint64_t);
+
+    // CONSTRUCTORS
+    ColumnFile() : pool(NULL), file(-1), built(false), counted(false), rows(0), last_page(-1) {}
+    ColumnFile(BufferPool* pool, const std::string& file_name, bool create = false);
+
+    // ACCESSORS
+    bool is_open() const { return file >= 0; }
+    long row_count() const;
+    bool get(long row, std::string& value) const;
+
+    // MUTATORS
+    long append(const char* data, int length);
+    bool redo(long row, const char* data, int length);
+    bool update(long row, const char* data, int length);
+    bool erase(long row);
+    void truncate(long rows);
+
+private:
+    BufferPool* pool;
+    int file;
+
+    // The directory of first row ids, one for each page, and
+    // the number of rows.  They're built when first needed
+    // and are only a cache of the pages, which is why
+    // lookups that build them are still const.
+    mutable jmiller::Vector<long> first_rows;
+    mutable bool built;
+    mutable bool counted;
+    mutable long rows;
+    mutable long last_page;
+
+    void build() const;
+    void count() const;
+    long find_page(long row) const;
+    static long first_row(const Page* page);
+};
+
+ColumnFile::ColumnFile(BufferPool* buffer_pool, const std::string& file_name, bool create)
+{
+    pool = buffer_pool;
+    file = pool->open_file(file_name, create);
+    built = false;
+    counted = false;
+    rows = 0;
+    last_page = -1;
+}
+
+long ColumnFile::row_count() const
+{
+    count();
+    return rows;
+}
+
+bool ColumnFile::get(long row, std::string& value) const
+{
+    const Page* page;
+    const char* data;
+    int length;
+    long page_no;
+    bool found;
+
+    page_no = find_page(row);
+
+    if (page_no < 0)
+        return false;
+
+    page = pool->read(file, page_no);
+
+    if (page == NULL)
+        return false;
+
+    found = page->get(row - first_rows[page_no] + 1, data, length);
+
+    if (found)
+        value.assign(data, length);
+
+    pool->release(file, page_no, page);
+    return found;
+}
+
+long ColumnFile::append(const char* data, int length)
+{
+    Page* page;
+    long page_no;
+    uint64_t first;
+
+    if (file < 0 || length > MAX_VALUE)
+        return 0;
+
+    count();
+
+    // The value goes in the last page if there is room,
+    // otherwise a new page is started
+    page = NULL;
+    page_no = pool->page_count(file) - 1;
+
+    if (page_no >= 0)
+    {
+        page = pool->fetch(file, page_no);
+
+        if (page != NULL && page->free_space() < length + Page::SLOT_SIZE)
+        {
+            pool->unpin(file, page_no, false);
+            page = NULL;
+        }
+    }
+
+    if (page == NULL)
+    {
+        page = pool->new_page(file, page_no);
+
+        if (page == NULL)
+            return 0;
+
+        if (built)
+            first_rows.push_back(rows + 1);
+    }
+
+    // A new or emptied page starts with the row id of
+    // the value about to be added
+    if (page->slot_count() <= 1)
+    {
+        first = rows + 1;
+        page->truncate(0);
+        page->insert((const char*)&first, sizeof(first));
+
+        if (built)
+            first_rows[page_no] = first;
+    }
+
+    page->insert(data, length);
+    pool->unpin(file, page_no, true);
+
+    return ++rows;
+}
+
+bool ColumnFile::redo(long row, const char* data, int length)
+{
+    if (row != row_count() + 1)
+        return false;
+
+    return append(data, length) == row;
+}
+
+bool ColumnFile::update(long row, const char* data, int length)
+{
+    Page* page;
+    long page_no;
+    bool done;
+
+    page_no = find_page(row);
+
+    if (page_no < 0)
+        return false;
+
+    page = pool->fetch(file, page_no);
+
+    if (page == NULL)
+        return false;
+
+    // The value keeps its slot so the rows after it
+    // keep their row ids
+    done = page->replace(row - first_rows[page_no] + 1, data, length);
+    pool->unpin(file, page_no, done);
+
+    return done;
+}
+
+bool ColumnFile::erase(long row)
+{
+    Page* page;
+    long page_no;
+    bool done;
+
+    page_no = find_page(row);
+
+    if (page_no < 0)
+        return false;
+
+    page = pool->fetch(file, page_no);
+
+    if (page == NULL)
+        return false;
+
+    done = page->erase(row - first_rows[page_no] + 1);
+    pool->unpin(file, page_no, done);
+
+    return done;
+}
+
+void ColumnFile::truncate(long keep)
+{
+    Page* page;
+    long page_count;
+    long values;
+
+    build();
+    page_count = pool->page_count(file);
+
+    // Pages holding only rows past keep are emptied rather
+    // than removed.  The next value appended goes in the
+    // last page.
+    for (long page_no = 0; page_no < page_count; page_no++)
+    {
+        page = pool->fetch(file, page_no);
+        values = page->slot_count() - 1;
+
+        if (values > 0 && first_rows[page_no] + values - 1 > keep)
+        {
+            if (first_rows[page_no] > keep)
+                page->truncate(0);
+            else
+                page->truncate(keep - first_rows[page_no] + 2);
+
+            pool->unpin(file, page_no, true);
+        }
+        else
+            pool->unpin(file, page_no, false);
+    }
+
+    built = false;
+    counted = false;
+    build();
+}
+
+void ColumnFile::build() const
+{
+    const Page* page;
+    long page_count;
+    long first;
+
+    if (built || file < 0)
+        return;
+
+    first_rows.clear();
+    rows = 0;
+    last_page = -1;
+    page_count = pool->page_count(file);
+
+    // Only the first slot of each page is read.  An empty
+    // page is given the row after the last one so the
+    // directory stays in order.
+    for (long page_no = 0; page_no < page_count; page_no++)
+    {
+        page = pool->read(file, page_no);
+        first = first_row(page);
+
+        if (first > 0)
+        {
+            first_rows.push_back(first);
+            rows = first + page->slot_count() - 2;
+        }
+        else
+            first_rows.push_back(rows + 1);
+
+        pool->release(file, page_no, page);
+    }
+
+    built = true;
+    counted = true;
+}
+
+void ColumnFile::count() const
+{
+    const Page* page;
+    long first;
+
+    if (counted || file < 0)
+        return;
+
+    rows = 0;
+
+    // The last page holding any values says how many rows
+    // there are, which is usually the last page
+    for (long page_no = pool->page_count(file) - 1; page_no >= 0 && rows == 0; page_no--)
+    {
+        page = pool->read(file, page_no);
+        first = first_row(page);
+
+        if (first > 0)
+            rows = first + page->slot_count() - 2;
+
+        pool->release(file, page_no, page);
+    }
+
+    counted = true;
+}
+
+long ColumnFile::find_page(long row) const
+{
+    long low;
+    long high;
+    long mid;
+
+    build();
+
+    if (row < 1 || row > rows)
+        return -1;
+
+    // Rows are usually read in order so the page of
+    // the last row found is tried first
+    if (last_page >= 0 && first_rows[last_page] <= row &&
+        (last_page + 1 == (long)first_rows.size() || row < first_rows[last_page + 1]))
+        return last_page;
+
+    // Finds the last page whose first row is no more than
+    // row.  Emptied pages share the first row of the page
+    // after them so the page holding row is the last one.
+    low = 0;
+    high = first_rows.size() - 1;
+
+    while (low < high)
+    {
+        mid = (low + high + 1) / 2;
+
+        if (first_rows[mid] <= row)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+
+    last_page = low;
+    return low;
+}
+
+long ColumnFile::first_row(const Page* page)
+{
+    const char* data;
+    int length;
+    uint64_t first;
+
+    // A page without any values, including one which was
+    // never written, has no first row
+    if (page == NULL || page->slot_count() < 2 || !page->get(0, data, length))
+        return 0;
+
+    memcpy(&first, data, sizeof(first));
+    return first;
+}
+
+#endif
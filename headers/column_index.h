@@ -0,0 +1,436 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: column_index.h
+
+CLASS PROVIDED: ColumnIndex
+    The index of one column of a Table, which maps each value
+    of the column to the RowSet of records holding it.  It's
+    kept in one of these forms, named by its kind:
+
+        TREE    a Map<Value, RowSet>, the B+ tree every column
+                has unless it's given another kind.
+        BITMAP  a BitmapIndex (see bitmap_index.h), for
+                columns with a few dozen values at most.
+        HASH    a HashIndex (see hash_index.h), for columns
+                mostly looked up by =.  Adding a value doesn't
+                touch a tree.  The entry numbers are only put
+                in key order when a range or other ordered scan
+                asks for them, and then only the entries added
+                since the last one are sorted and merged in.
+
+    Every form has the same functions, so the Table uses a
+    ColumnIndex the same way whatever its kind.  The kind of
+    each column is kept in the catalog (see catalog.h).
+
+CONSTRUCTORS:
+    ColumnIndex(int kind = TREE)
+        Postcondition: An empty index of kind has been created.
+
+STATIC FUNCTIONS:
+    static bool parse_kind(const std::string& name, int& kind)
+        Postcondition: kind holds the kind called name.  Returns false
+                       if there's no such kind.
+
+    static std::string kind_name(int kind)
+        Postcondition: The name of kind has been returned.
+
+ACCESSORS:
+    int kind() const
+        Postcondition: The kind of the index has been returned.
+
+    bool empty() const
+        Postcondition: A bool indicating if the index has no values
+                       has been returned.
+
+    bool contains(const Value& key) const
+        Postcondition: A bool indicating if key is in the index has
+                       been returned.
+
+    const RowSet* find(const Value& key)
+        Postcondition: The RowSet of key has been returned, or NULL if
+                       key isn't in the index.  It's found in one
+                       lookup, whatever the kind.
+
+    Iterator begin()
+    Iterator end()
+    Iterator lower_bound(const Value& key)
+    Iterator upper_bound(const Value& key)
+        Postcondition: Iterators over the values in order.  Each item
+                       is a Pair of a value and its RowSet, given by
+                       reference so the set isn't copied.
+
+MUTATORS:
+    RowSet& operator[](const Value& key)
+        Postcondition: The RowSet of key has been returned.  If key had
+                       none an empty one has been added.
+
+    void bulk_load(const jmiller::Vector<Pair<Value, RowSet> >& pairs)
+        Precondition: pairs is sorted by key with no key repeated.
+        Postcondition: The index holds exactly pairs.
+
+    void set_kind(int kind)
+        Postcondition: The index is of kind and holds the same values
+                       and records it did.
+
+*/
+#ifndef COLUMN_INDEX_H
+#define COLUMN_INDEX_H
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+#include "./map.h"
+#include "./bitmap_index.h"
+#include "./hash_index.h"
+#include "./row_set.h"
+#include "./value.h"
+#include "./vector.h"
+
+class ColumnIndex
+{
+public:
+    // STATIC MEMBER CONSTANTS
+    static const int TREE = 0;
+    static const int BITMAP = 1;
+    static const int HASH = 2;
+
+    class Iterator
+    {
+    public:
+        friend class ColumnIndex;
+        Iterator() : _kind(TREE), _hash(NULL), _order(NULL), _at(0) {}
+        Iterator(Map<Value, RowSet>::Iterator it)
+            : _kind(TREE), _tree_it(it), _hash(NULL), _order(NULL), _at(0) {}
+        Iterator(BitmapIndex::Iterator it)
+            : _kind(BITMAP), _bitmap_it(it), _hash(NULL), _order(NULL), _at(0) {}
+        Iterator(const jmiller::Vector<int>* order, int at, HashIndex* hash)
+            : _kind(HASH), _hash(hash), _order(order), _at(at) {}
+
+        Iterator operator ++(int)
+        {
+            Iterator temp;
+            temp = *this;
+
+            ++(*this);
+            return temp;
+        }
+        Iterator operator ++()
+        {
+            if (_kind == TREE)
+                ++_tree_it;
+            else if (_kind == BITMAP)
+                ++_bitmap_it;
+            else
+                ++_at;
+
+            return *this;
+        }
+        const Pair<Value, RowSet>& operator *()
+        {
+            if (_kind == TREE)
+                return *_tree_it;
+
+            if (_kind == BITMAP)
+                return *_bitmap_it;
+
+            return _hash->entry((*_order)[_at]);
+        }
+        friend bool operator ==(const Iterator& lhs, const Iterator& rhs)
+        {
+            if (lhs._kind != rhs._kind)
+                return false;
+
+            if (lhs._kind == TREE)
+                return lhs._tree_it == rhs._tree_it;
+
+            if (lhs._kind == BITMAP)
+                return lhs._bitmap_it == rhs._bitmap_it;
+
+            return lhs._order == rhs._order && lhs._at == rhs._at;
+        }
+        friend bool operator !=(const Iterator& lhs, const Iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+    private:
+        int _kind;
+        Map<Value, RowSet>::Iterator _tree_it;
+        BitmapIndex::Iterator _bitmap_it;
+        HashIndex* _hash;
+        const jmiller::Vector<int>* _order;
+        int _at;
+    };
+
+    // CONSTRUCTORS
+    ColumnIndex(int kind = TREE) : index_kind(kind) {}
+
+    static bool parse_kind(const std::string& name, int& kind);
+    static std::string kind_name(int kind);
+
+    // ACCESSORS
+    int kind() const { return index_kind; }
+    bool empty() const;
+    bool contains(const Value& key) const;
+    const RowSet* find(const Value& key);
+
+    Iterator begin();
+    Iterator end();
+    Iterator lower_bound(const Value& key);
+    Iterator upper_bound(const Value& key);
+
+    // MUTATORS
+    RowSet& operator[](const Value& key);
+    void bulk_load(const jmiller::Vector<Pair<Value, RowSet> >& pairs);
+    void set_kind(int kind);
+
+private:
+    int index_kind;
+    Map<Value, RowSet> tree;
+    BitmapIndex bitmap;
+    HashIndex hash;
+
+    // The entry numbers of hash in key order, as of the
+    // last ordered scan.  Entries are never taken out of
+    // hash, so the ones from order.size() on are new.
+    jmiller::Vector<int> order;
+
+    // Orders entry numbers by their keys
+    struct EntryLess
+    {
+        const HashIndex* hash;
+        EntryLess(const HashIndex* h) : hash(h) {}
+        bool operator ()(int a, int b) const
+        {
+            return hash->entry(a).key < hash->entry(b).key;
+        }
+    };
+
+    void sort_order();
+    int order_bound(const Value& key, bool after);
+};
+
+bool ColumnIndex::parse_kind(const std::string& name, int& kind)
+{
+    if (name == "tree")
+        kind = TREE;
+    else if (name == "bitmap")
+        kind = BITMAP;
+    else if (name == "hash")
+        kind = HASH;
+    else
+        return false;
+
+    return true;
+}
+
+std::string ColumnIndex::kind_name(int kind)
+{
+    if (kind == BITMAP)
+        return "bitmap";
+
+    return kind == HASH ? "hash" : "tree";
+}
+
+bool ColumnIndex::empty() const
+{
+    if (index_kind == TREE)
+        return tree.empty();
+
+    if (index_kind == BITMAP)
+        return bitmap.empty();
+
+    return hash.size() == 0;
+}
+
+bool ColumnIndex::contains(const Value& key) const
+{
+    if (index_kind == TREE)
+        return tree.contains(key);
+
+    if (index_kind == BITMAP)
+        return bitmap.contains(key);
+
+    return hash.find(key) >= 0;
+}
+
+const RowSet* ColumnIndex::find(const Value& key)
+{
+    int entry;
+
+    if (index_kind == TREE)
+        return tree.find(key);
+
+    if (index_kind == BITMAP)
+        return bitmap.find(key);
+
+    // One probe of the hash table finds both
+    // whether key is there and its records
+    entry = hash.find(key);
+    return entry >= 0 ? &hash.entry(entry).value : NULL;
+}
+
+ColumnIndex::Iterator ColumnIndex::begin()
+{
+    if (index_kind == TREE)
+        return Iterator(tree.begin());
+
+    if (index_kind == BITMAP)
+        return Iterator(bitmap.begin());
+
+    sort_order();
+    return Iterator(&order, 0, &hash);
+}
+
+ColumnIndex::Iterator ColumnIndex::end()
+{
+    if (index_kind == TREE)
+        return Iterator(tree.end());
+
+    if (index_kind == BITMAP)
+        return Iterator(bitmap.end());
+
+    sort_order();
+    return Iterator(&order, order.size(), &hash);
+}
+
+ColumnIndex::Iterator ColumnIndex::lower_bound(const Value& key)
+{
+    if (index_kind == TREE)
+        return Iterator(tree.lower_bound(key));
+
+    if (index_kind == BITMAP)
+        return Iterator(bitmap.lower_bound(key));
+
+    return Iterator(&order, order_bound(key, false), &hash);
+}
+
+ColumnIndex::Iterator ColumnIndex::upper_bound(const Value& key)
+{
+    if (index_kind == TREE)
+        return Iterator(tree.upper_bound(key));
+
+    if (index_kind == BITMAP)
+        return Iterator(bitmap.upper_bound(key));
+
+    return Iterator(&order, order_bound(key, true), &hash);
+}
+
+RowSet& ColumnIndex::operator[](const Value& key)
+{
+    if (index_kind == TREE)
+        return tree[key];
+
+    if (index_kind == BITMAP)
+        return bitmap[key];
+
+    // A new value is put in order by the next ordered scan
+    return hash.entry(hash.insert(key)).value;
+}
+
+void ColumnIndex::bulk_load(const jmiller::Vector<Pair<Value, RowSet> >& pairs)
+{
+    int entry;
+
+    if (index_kind == TREE)
+        tree.bulk_load(pairs);
+    else if (index_kind == BITMAP)
+        bitmap.bulk_load(pairs);
+    else
+    {
+        hash.clear();
+        order.clear();
+
+        // The pairs are in order so the entry
+        // numbers are loaded in the same order
+        for (int i = 0; i < pairs.size(); i++)
+        {
+            entry = hash.insert(pairs[i].key);
+            hash.entry(entry).value = pairs[i].value;
+            order.push_back(entry);
+        }
+    }
+}
+
+void ColumnIndex::set_kind(int kind)
+{
+    jmiller::Vector<Pair<Value, RowSet> > pairs;
+
+    if (kind == index_kind)
+        return;
+
+    // The values come out in order so the new
+    // form is built from them in one go
+    for (Iterator it = begin(); it != end(); ++it)
+        pairs.push_back(*it);
+
+    if (index_kind == TREE)
+        tree.clear();
+    else if (index_kind == BITMAP)
+        bitmap.clear();
+    else
+    {
+        hash.clear();
+        order.clear();
+    }
+
+    index_kind = kind;
+    bulk_load(pairs);
+}
+
+void ColumnIndex::sort_order()
+{
+    int sorted;
+    int* first;
+
+    sorted = order.size();
+
+    if (sorted == hash.size())
+        return;
+
+    // The entries added since the last scan are sorted
+    // on their own and merged with the ones in order
+    for (int i = sorted; i < hash.size(); i++)
+        order.push_back(i);
+
+    first = &order[0];
+    std::sort(first + sorted, first + order.size(), EntryLess(&hash));
+    std::inplace_merge(first, first + sorted, first + order.size(), EntryLess(&hash));
+}
+
+int ColumnIndex::order_bound(const Value& key, bool after)
+{
+    int low;
+    int high;
+    int mid;
+
+    sort_order();
+
+    low = 0;
+    high = order.size();
+
+    // The first entry above key, or not below it
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+
+        if (hash.entry(order[mid]).key < key ||
+            (after && hash.entry(order[mid]).key == key))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+#endif
@@ -0,0 +1,261 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: dictionary.h
+
+CLASS PROVIDED: Dictionary
+    The strings of a dict column (see value.h).  Each string
+    the column holds is given a small integer code, and the
+    records and index of the column hold the code instead
+    of the string.
+
+    Codes are handed out in the order strings are first
+    seen and never change, so records never need to be
+    written again when a string is added.  The strings are
+    also kept in order in a Map so a range of strings can
+    be turned into the codes which are in it.
+
+FILE FORMAT:
+    entries: [length : 4 bytes][string]
+
+    The n'th entry is the string with code n.  Entries are
+    only ever appended.
+
+    A dictionary is opened once per program with open() and
+    shared by every Table which uses it, the same way a
+    table's write-ahead log is.
+
+STATIC FUNCTIONS:
+    static Dictionary* open(const std::string& file_name, bool create = false)
+        Postcondition: The dictionary stored in file_name has been
+                       returned.  If create is true it has been emptied.
+
+    static void sync_all()
+        Postcondition: Every string added to any dictionary has been
+                       forced to disk.
+
+ACCESSORS:
+    int size() const
+        Postcondition: The number of strings has been returned.
+
+    bool find(const std::string& value, uint32_t& code)
+        Postcondition: code holds the code of value.  Returns false if
+                       value isn't in the dictionary.
+
+    std::string decode(uint32_t code) const
+        Postcondition: The string with code has been returned, or an
+                       empty string if there is no such code.
+
+    Iterator begin()
+    Iterator end()
+    Iterator lower_bound(const std::string& value)
+    Iterator upper_bound(const std::string& value)
+        Postcondition: Iterators over the strings in order.  Each item
+                       is a Pair of a string and its code.
+
+MUTATORS:
+    uint32_t encode(const std::string& value)
+        Postcondition: The code of value has been returned.  If value
+                       wasn't in the dictionary it has been added.
+
+    void sync()
+        Postcondition: The strings added have been forced to disk.
+
+*/
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <stdint.h>
+#include "./map.h"
+#include "./vector.h"
+#include "./wal.h"
+
+class Dictionary
+{
+public:
+    typedef Map<std::string, uint32_t>::Iterator Iterator;
+
+    static Dictionary* open(const std::string& file_name, bool create = false);
+    static void sync_all();
+
+    // ACCESSORS
+    int size() const { return strings.size(); }
+    bool find(const std::string& value, uint32_t& code);
+    std::string decode(uint32_t code) const;
+
+    Iterator begin() { return codes.begin(); }
+    Iterator end() { return codes.end(); }
+    Iterator lower_bound(const std::string& value) { return codes.lower_bound(value); }
+    Iterator upper_bound(const std::string& value) { return codes.upper_bound(value); }
+
+    // MUTATORS
+    uint32_t encode(const std::string& value);
+    void sync();
+
+private:
+    static Map<std::string, Dictionary*> open_dictionaries;
+
+    std::string file_name;
+    FILE* file;
+    Map<std::string, uint32_t> codes;
+    jmiller::Vector<std::string> strings;
+    bool unsynced;
+
+    // CONSTRUCTORS
+    Dictionary(const std::string& file_name, bool create);
+
+    // A dictionary can't be copied
+    Dictionary(const Dictionary& other);
+    Dictionary& operator =(const Dictionary& rhs);
+
+    void read();
+};
+
+Map<std::string, Dictionary*> Dictionary::open_dictionaries;
+
+Dictionary* Dictionary::open(const std::string& name, bool create)
+{
+    Dictionary* dictionary;
+
+    if (open_dictionaries.contains(name))
+    {
+        if (!create)
+            return open_dictionaries[name];
+
+        // A table made again starts with an empty dictionary
+        delete open_dictionaries[name];
+    }
+
+    dictionary = new Dictionary(name, create);
+    open_dictionaries.insert(name, dictionary);
+
+    return dictionary;
+}
+
+void Dictionary::sync_all()
+{
+    for (Map<std::string, Dictionary*>::Iterator it = open_dictionaries.begin();
+         it != open_dictionaries.end(); ++it)
+        (*it).value->sync();
+}
+
+Dictionary::Dictionary(const std::string& name, bool create)
+{
+    file_name = name;
+    unsynced = false;
+
+    // Opened for reading anywhere and appending to the end
+    file = fopen(file_name.c_str(), create ? "w+b" : "a+b");
+
+    if (file == NULL)
+        std::cout << "Couldn't open " << file_name << "." << std::endl;
+    else if (!create)
+        read();
+}
+
+bool Dictionary::find(const std::string& value, uint32_t& code)
+{
+    if (!codes.contains(value))
+        return false;
+
+    code = codes[value];
+    return true;
+}
+
+std::string Dictionary::decode(uint32_t code) const
+{
+    if (code >= strings.size())
+        return std::string();
+
+    return strings[code];
+}
+
+uint32_t Dictionary::encode(const std::string& value)
+{
+    uint32_t code;
+    uint32_t length;
+
+    if (find(value, code))
+        return code;
+
+    code = strings.size();
+    length = value.size();
+
+    strings.push_back(value);
+    codes.insert(value, code);
+
+    // The entry is handed to the operating system now and
+    // forced to disk by sync(), which happens before any log
+    // record that uses the code is committed
+    if (file != NULL)
+    {
+        fwrite(&length, sizeof(length), 1, file);
+        fwrite(value.data(), 1, length, file);
+        fflush(file);
+        unsynced = true;
+    }
+
+    return code;
+}
+
+void Dictionary::sync()
+{
+    if (!unsynced || file == NULL)
+        return;
+
+    sync_file(file);
+    unsynced = false;
+}
+
+void Dictionary::read()
+{
+    uint32_t length;
+    std::string value;
+    long good_size;
+
+    fseek(file, 0, SEEK_SET);
+    good_size = 0;
+
+    while (fread(&length, sizeof(length), 1, file) == 1)
+    {
+        value.resize(length);
+
+        if (length > 0 && fread(&value[0], 1, length, file) != length)
+            break;
+
+        codes.insert(value, strings.size());
+        strings.push_back(value);
+        good_size = ftell(file);
+    }
+
+    // An entry cut short when the program stopped is
+    // dropped so the next one is written after the last
+    // whole entry
+    fseek(file, 0, SEEK_END);
+
+    if (ftell(file) != good_size)
+    {
+        fflush(file);
+#ifdef _WIN32
+        _chsize(_fileno(file), good_size);
+#else
+        if (ftruncate(fileno(file), good_size) != 0)
+            std::cout << "Failed to truncate " << file_name << std::endl;
+#endif
+        fseek(file, 0, SEEK_END);
+    }
+}
+
+#endif
@@ -0,0 +1,333 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: hash_index.h
+
+CLASS PROVIDED: HashIndex
+    A hash table from the values of a column to the RowSet of
+    the records holding them, for finding one value in a
+    probe or two rather than a descent of a tree.
+
+    Each value is an entry, numbered in the order it was
+    added, and entries are never moved or taken out, so an
+    entry's number can be kept elsewhere (see column_index.h).
+    The buckets hold an entry's number and the hash of its
+    value, so a probe compares hashes within one array and
+    only reads the entry when they match.  Collisions take
+    the next free bucket (open addressing).
+
+    When half the buckets are used a table twice the size is
+    made and the old buckets are moved into it a few at a
+    time by each insert after, so no insert moves them all.
+    Until they're all moved a value is looked for in both.
+
+CONSTRUCTORS:
+    HashIndex()
+        Postcondition: An empty index has been created.
+
+    HashIndex(HashIndex&& other)
+        Postcondition: The index holds the entries and buckets of other,
+                       which is left empty.  Assigning from an rvalue does
+                       the same.
+
+ACCESSORS:
+    int size() const
+        Postcondition: The number of entries has been returned.
+
+    int find(const Value& key) const
+        Postcondition: The number of the entry of key has been returned,
+                       or -1 if it has none.
+
+    Pair<Value, RowSet>& entry(int n) *** has const version ***
+        Precondition: 0 <= n < size()
+        Postcondition: Entry n has been returned.
+
+MUTATORS:
+    int insert(const Value& key)
+        Postcondition: The number of the entry of key has been returned.
+                       If key had none an entry with an empty RowSet
+                       has been added.
+
+    void clear()
+        Postcondition: The index has no entries.
+
+*/
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include <iostream>
+#include <cstdlib>
+#include <utility>
+#include "./map.h"
+#include "./row_set.h"
+#include "./value.h"
+#include "./vector.h"
+
+class HashIndex
+{
+public:
+    // CONSTRUCTORS
+    HashIndex();
+
+    // BIG THREE
+    HashIndex(const HashIndex& other);
+    ~HashIndex();
+    HashIndex& operator =(const HashIndex& rhs);
+
+    // MOVE
+    HashIndex(HashIndex&& other);
+    HashIndex& operator =(HashIndex&& rhs);
+
+    // ACCESSORS
+    int size() const { return entries.size(); }
+    int find(const Value& key) const;
+    Pair<Value, RowSet>& entry(int n) { return entries[n]; }
+    const Pair<Value, RowSet>& entry(int n) const { return entries[n]; }
+
+    // MUTATORS
+    int insert(const Value& key);
+    void clear();
+
+private:
+    struct Bucket
+    {
+        std::size_t hash;
+        int entry;
+    };
+
+    // STATIC MEMBER CONSTANTS
+    static const int EMPTY = -1;
+    static const int MIN_BUCKETS = 16;
+    static const int MOVES_PER_INSERT = 4;
+
+    jmiller::Vector<Pair<Value, RowSet> > entries;
+    Bucket* buckets;
+    int bucket_count;
+    Bucket* old_buckets;
+    int old_count;
+    int moved;
+
+    int probe(const Bucket* table, int count, std::size_t hash, const Value& key) const;
+    static void place(Bucket* table, int count, std::size_t hash, int entry);
+    static Bucket* make_buckets(int count);
+    void grow();
+    void move_some(int moves);
+    void rebuild();
+    void take(HashIndex& other);
+};
+
+HashIndex::HashIndex() : old_buckets(NULL), old_count(0), moved(0)
+{
+    bucket_count = MIN_BUCKETS;
+    buckets = make_buckets(bucket_count);
+}
+
+HashIndex::HashIndex(const HashIndex& other)
+    : entries(other.entries), buckets(NULL), old_buckets(NULL), old_count(0), moved(0)
+{
+    rebuild();
+}
+
+HashIndex::~HashIndex()
+{
+    delete [] buckets;
+    delete [] old_buckets;
+}
+
+HashIndex& HashIndex::operator =(const HashIndex& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    entries = rhs.entries;
+    rebuild();
+
+    return *this;
+}
+
+HashIndex::HashIndex(HashIndex&& other)
+    : buckets(NULL), old_buckets(NULL)
+{
+    take(other);
+}
+
+HashIndex& HashIndex::operator =(HashIndex&& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    delete [] buckets;
+    delete [] old_buckets;
+    take(rhs);
+
+    return *this;
+}
+
+int HashIndex::find(const Value& key) const
+{
+    std::size_t hash;
+    int found;
+
+    hash = key.hash();
+    found = probe(buckets, bucket_count, hash, key);
+
+    // A value which hasn't been moved yet
+    // is still in the old buckets
+    if (found == EMPTY && old_buckets != NULL)
+        found = probe(old_buckets, old_count, hash, key);
+
+    return found;
+}
+
+int HashIndex::insert(const Value& key)
+{
+    std::size_t hash;
+    int found;
+
+    found = find(key);
+
+    if (found != EMPTY)
+        return found;
+
+    if ((entries.size() + 1) * 2 > bucket_count)
+        grow();
+
+    hash = key.hash();
+    entries.push_back(Pair<Value, RowSet>(key));
+    place(buckets, bucket_count, hash, entries.size() - 1);
+    move_some(MOVES_PER_INSERT);
+
+    return entries.size() - 1;
+}
+
+void HashIndex::clear()
+{
+    entries = jmiller::Vector<Pair<Value, RowSet> >();
+    rebuild();
+}
+
+int HashIndex::probe(const Bucket* table, int count, std::size_t hash, const Value& key) const
+{
+    int at;
+
+    // count is a power of two so the mask wraps
+    // the probe around the end of the table
+    at = hash & (count - 1);
+
+    while (table[at].entry != EMPTY)
+    {
+        if (table[at].hash == hash && entries[table[at].entry].key == key)
+            return table[at].entry;
+
+        at = (at + 1) & (count - 1);
+    }
+
+    return EMPTY;
+}
+
+void HashIndex::place(Bucket* table, int count, std::size_t hash, int entry)
+{
+    int at;
+
+    at = hash & (count - 1);
+
+    while (table[at].entry != EMPTY)
+        at = (at + 1) & (count - 1);
+
+    table[at].hash = hash;
+    table[at].entry = entry;
+}
+
+HashIndex::Bucket* HashIndex::make_buckets(int count)
+{
+    Bucket* table;
+
+    table = new Bucket[count];
+
+    for (int i = 0; i < count; i++)
+        table[i].entry = EMPTY;
+
+    return table;
+}
+
+void HashIndex::grow()
+{
+    // The last table must be moved in full before
+    // there are three tables to look in
+    if (old_buckets != NULL)
+        move_some(old_count);
+
+    old_buckets = buckets;
+    old_count = bucket_count;
+    moved = 0;
+
+    bucket_count *= 2;
+    buckets = make_buckets(bucket_count);
+}
+
+void HashIndex::move_some(int moves)
+{
+    if (old_buckets == NULL)
+        return;
+
+    // Moves at most moves buckets, which is enough to
+    // empty the old table before the new one is half full
+    for (int i = 0; i < moves && moved < old_count; i++, moved++)
+        if (old_buckets[moved].entry != EMPTY)
+            place(buckets, bucket_count, old_buckets[moved].hash, old_buckets[moved].entry);
+
+    if (moved == old_count)
+    {
+        delete [] old_buckets;
+        old_buckets = NULL;
+        old_count = 0;
+        moved = 0;
+    }
+}
+
+void HashIndex::take(HashIndex& other)
+{
+    // The tables are handed over and other
+    // is given an empty one of its own
+    entries = std::move(other.entries);
+    buckets = other.buckets;
+    bucket_count = other.bucket_count;
+    old_buckets = other.old_buckets;
+    old_count = other.old_count;
+    moved = other.moved;
+
+    other.old_buckets = NULL;
+    other.old_count = 0;
+    other.moved = 0;
+    other.bucket_count = MIN_BUCKETS;
+    other.buckets = make_buckets(MIN_BUCKETS);
+}
+
+void HashIndex::rebuild()
+{
+    delete [] buckets;
+    delete [] old_buckets;
+    old_buckets = NULL;
+    old_count = 0;
+    moved = 0;
+
+    bucket_count = MIN_BUCKETS;
+
+    while (bucket_count < entries.size() * 2)
+        bucket_count *= 2;
+
+    buckets = make_buckets(bucket_count);
+
+    for (int i = 0; i < entries.size(); i++)
+        place(buckets, bucket_count, entries[i].key.hash(), i);
+}
+
+#endif
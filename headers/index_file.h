@@ -0,0 +1,480 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: index_file.h
+
+CLASS PROVIDED: IndexFile
+    Stores the index of a single table column in a binary
+    companion file so a Table can be opened without scanning
+    every record to rebuild its indices.
+
+FILE FORMAT:
+    header:  ["RDMSIDX2" : 8 bytes][last recno : 8 bytes][snapshot entries : 8 bytes]
+    entries: [key length : 4 bytes][key][count : 4 bytes][recnos : 8 bytes each]
+             [checksum : 4 bytes]
+
+    A snapshot writes one entry per key in key order.  Keys
+    are stored in the binary form of the column's type (see
+    value.h).  A table can be ahead of its index files, the
+    file covers every record up to the last recno in its
+    header and none after it.
+
+    A snapshot is written to a copy which is forced to disk
+    and renamed over the old file, so the file is never left
+    half written.  The header says how many entries the
+    snapshot has and a file with fewer is read as no file
+    at all, which has the index rebuilt from its table.
+    So is a file with an entry cut short or whose checksum
+    doesn't match, such as one whose last appended entry
+    was only partly written.
+
+    Records deleted, or added in the slot of a deleted
+    record, after the snapshot was written are appended as
+    more entries rather than writing the snapshot again.
+    An entry whose count has the REMOVED bit set takes its
+    recnos out of the key's list.  A file written before
+    the header had its name or its entry count is read
+    as no file at all.
+
+    New records at the end of the table are appended too,
+    and the last recno in the header is moved on once their
+    entries are on disk.  Recnos after the last one in the
+    header are left out when the file is read, so entries
+    whose header wasn't moved on are read from the table
+    again instead.
+
+    The recnos of each key are read into a RowSet (see
+    row_set.h), which keeps them in order whatever order
+    they were written in.
+
+CONSTRUCTORS:
+    IndexFile(const std::string& file_name)
+        Postcondition: An IndexFile for file_name has been created.
+                       The file itself is not touched.
+
+ACCESSORS:
+    bool exists()
+        Postcondition: A bool indicating if the index file exists on
+                       disk has been returned.
+
+    std::size_t last_indexed()
+        Postcondition: The last recno covered by the index file has been
+                       returned, or 0 if there is no index file.
+
+    bool read(ColumnIndex& index, const FieldType& type)
+        Postcondition: Every posting in the file has been added to index.
+                       Returns false, with index emptied, if the file
+                       couldn't be opened, is missing some of its
+                       snapshot or has an entry which wasn't whole.
+
+    bool outgrown() const
+        Postcondition: A bool indicating if the last read() found more
+                       entries after the snapshot than in it has been
+                       returned.
+
+MUTATORS:
+    void write(ColumnIndex& index, const FieldType& type,
+               std::size_t last)
+        Postcondition: The file has been replaced with a snapshot of
+                       index covering every recno up to last, which is
+                       on disk.
+
+    void append(const jmiller::Vector<MPair<Value, std::size_t> >& entries,
+                const FieldType& type, bool removed)
+        Postcondition: The entries have been added to the end of the file
+                       and forced to disk.  If removed is true they take
+                       their recnos out of the index when it's read.
+                       Nothing is written if the file doesn't exist.
+
+    void extend(std::size_t after, std::size_t last)
+        Postcondition: If the file covered every recno up to after it
+                       now covers every one up to last, and its header
+                       is on disk.  The entries of the recnos between
+                       must have been appended first.
+
+*/
+#ifndef INDEX_FILE_H
+#define INDEX_FILE_H
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdint.h>
+#include "./wal.h"
+#include "./map.h"
+#include "./mmap.h"
+#include "./column_index.h"
+#include "./row_set.h"
+#include "./value.h"
+#include "./vector.h"
+
+bool file_exists(const std::string file)
+{
+    std::ifstream f(file.c_str(), std::ifstream::binary);
+    return f.good();
+}
+
+class IndexFile
+{
+public:
+    // CONSTRUCTORS
+    IndexFile(const std::string& file_name);
+
+    // ACCESSORS
+    bool exists() { return file_exists(file_name); }
+    std::size_t last_indexed();
+    bool read(ColumnIndex& index, const FieldType& type);
+    bool outgrown() const { return appended_count > snapshot_count; }
+
+    // MUTATORS
+    void write(ColumnIndex& index, const FieldType& type,
+               std::size_t last);
+    void append(const jmiller::Vector<MPair<Value, std::size_t> >& entries,
+                const FieldType& type, bool removed);
+    void extend(std::size_t after, std::size_t last);
+
+private:
+    // STATIC MEMBER CONSTANTS
+    static const uint32_t REMOVED = 0x80000000u;
+
+    std::string file_name;
+    std::size_t snapshot_count;
+    std::size_t appended_count;
+
+    static bool read_header(std::istream& ins, uint64_t& last, uint64_t& entries);
+    static bool read_entry(std::istream& ins, uint32_t key_length, std::string& key,
+                           uint32_t& count, jmiller::Vector<std::size_t>& recnos);
+    static uint32_t checksum(uint32_t hash, const void* data, std::size_t length);
+    void write_entry(FILE* file, const std::string& key,
+                     const jmiller::Vector<std::size_t>& recnos, bool removed);
+};
+
+IndexFile::IndexFile(const std::string& name)
+{
+    file_name = name;
+    snapshot_count = 0;
+    appended_count = 0;
+}
+
+std::size_t IndexFile::last_indexed()
+{
+    std::ifstream fs;
+    uint64_t last;
+    uint64_t snapshot;
+
+    fs.open(file_name.c_str(), std::ifstream::binary);
+
+    if (fs.fail() || !read_header(fs, last, snapshot))
+        return 0;
+
+    return last;
+}
+
+bool IndexFile::read(ColumnIndex& index, const FieldType& type)
+{
+    std::ifstream fs;
+    uint64_t last;
+    uint64_t snapshot;
+    uint64_t read_count;
+    uint32_t key_length;
+    uint32_t count;
+    std::string key;
+    jmiller::Vector<std::size_t> recnos;
+    jmiller::Vector<Pair<Value, RowSet> > entries;
+    bool removed;
+    bool in_order;
+
+    fs.open(file_name.c_str(), std::ifstream::binary);
+
+    if (fs.fail() || !read_header(fs, last, snapshot))
+        return false;
+
+    in_order = true;
+    read_count = 0;
+    snapshot_count = snapshot;
+    appended_count = 0;
+
+    // Each entry holds a key followed by its posting list
+    while (fs.read((char*)&key_length, sizeof(key_length)))
+    {
+        // Nothing in a file with a broken entry can be
+        // trusted, so what was read of it is thrown away
+        if (!read_entry(fs, key_length, key, count, recnos))
+        {
+            index = ColumnIndex(index.kind());
+            return false;
+        }
+
+        read_count++;
+        removed = (count & REMOVED) != 0;
+
+        if (read_count > snapshot)
+            appended_count++;
+
+        Pair<Value, RowSet> entry(Value::decode(type, key.data(), key_length));
+
+        // New records whose entries got to the file before
+        // its header was moved on aren't covered by it yet
+        for (int i = 0; i < recnos.size(); i++)
+            if (recnos[i] <= last)
+                entry.value.add(recnos[i]);
+
+        // The snapshot is in key order so the tree can be
+        // built bottom up from it, each set packed as small
+        // as it goes.  The entries appended after it are
+        // applied one at a time.
+        if (in_order && !removed && index.empty() &&
+            (entries.size() == 0 || entries[entries.size() - 1].key < entry.key))
+        {
+            entry.value.optimize();
+            entries.push_back(entry);
+            continue;
+        }
+
+        if (in_order)
+        {
+            if (entries.size() > 0)
+                index.bulk_load(entries);
+            in_order = false;
+        }
+
+        if (!removed)
+            index[entry.key] |= entry.value;
+        else if (index.contains(entry.key))
+        {
+            RowSet& recnos = index[entry.key];
+            jmiller::Vector<std::size_t> gone = entry.value.rows();
+
+            for (int i = 0; i < gone.size(); i++)
+                recnos.remove(gone[i]);
+        }
+    }
+
+    if (in_order && entries.size() > 0)
+        index.bulk_load(entries);
+
+    // A file cut short before the end of its snapshot
+    // doesn't cover the records its header says it does
+    if (read_count < snapshot)
+    {
+        index = ColumnIndex(index.kind());
+        return false;
+    }
+
+    return true;
+}
+
+void IndexFile::write(ColumnIndex& index, const FieldType& type,
+                      std::size_t last)
+{
+    FILE* file;
+    std::string temp_name;
+    uint64_t last_out;
+    uint64_t count;
+
+    temp_name = file_name + ".tmp";
+    file = fopen(temp_name.c_str(), "wb");
+
+    if (file == NULL)
+    {
+        std::cout << "Couldn't write " << temp_name << "." << std::endl;
+        return;
+    }
+
+    last_out = last;
+    count = 0;
+
+    fwrite("RDMSIDX2", 1, 8, file);
+    fwrite(&last_out, sizeof(last_out), 1, file);
+    fwrite(&count, sizeof(count), 1, file);
+
+    // The index iterates in key order so the snapshot is
+    // written sorted.  Keys whose records were all
+    // deleted are left out.
+    for (ColumnIndex::Iterator it = index.begin();
+         it != index.end(); ++it)
+    {
+        const Pair<Value, RowSet>& entry = *it;
+
+        if (!entry.value.empty())
+        {
+            write_entry(file, entry.key.encode(type), entry.value.rows(), false);
+            count++;
+        }
+    }
+
+    // The count goes in the header once it's known
+    fseek(file, 8 + sizeof(last_out), SEEK_SET);
+    fwrite(&count, sizeof(count), 1, file);
+
+    // The copy is on disk before it replaces the old
+    // file so one or the other is always whole
+    sync_file(file);
+    fclose(file);
+
+#ifdef _WIN32
+    remove(file_name.c_str());
+#endif
+    if (rename(temp_name.c_str(), file_name.c_str()) != 0)
+        std::cout << "Couldn't replace " << file_name << "." << std::endl;
+}
+
+void IndexFile::append(const jmiller::Vector<MPair<Value, std::size_t> >& entries,
+                       const FieldType& type, bool removed)
+{
+    FILE* file;
+
+    // A missing file is built from its table when its
+    // index is loaded, so there's nothing to add to
+    if (entries.size() == 0 || !exists())
+        return;
+
+    file = fopen(file_name.c_str(), "ab");
+
+    if (file == NULL)
+        return;
+
+    for (int i = 0; i < entries.size(); i++)
+        write_entry(file, entries[i].key.encode(type), entries[i].value_list, removed);
+
+    // The log records of the entries may be thrown away
+    // once the table is checkpointed, so the file mustn't
+    // rely on the operating system to write them
+    sync_file(file);
+    fclose(file);
+}
+
+void IndexFile::extend(std::size_t after, std::size_t last)
+{
+    FILE* file;
+    char tag[8];
+    uint64_t covered;
+    uint64_t last_out;
+
+    file = fopen(file_name.c_str(), "r+b");
+
+    if (file == NULL)
+        return;
+
+    // A file which is behind its table is caught up by
+    // load_index(), so only one which covers every record
+    // before the new ones is moved on
+    if (fread(tag, 1, sizeof(tag), file) == sizeof(tag) && memcmp(tag, "RDMSIDX2", 8) == 0 &&
+        fread(&covered, sizeof(covered), 1, file) == 1 && covered >= after && covered < last)
+    {
+        last_out = last;
+        fseek(file, 8, SEEK_SET);
+        fwrite(&last_out, sizeof(last_out), 1, file);
+        sync_file(file);
+    }
+
+    fclose(file);
+}
+
+bool IndexFile::read_header(std::istream& ins, uint64_t& last, uint64_t& entries)
+{
+    char tag[8];
+
+    ins.read(tag, sizeof(tag));
+
+    if (!ins || memcmp(tag, "RDMSIDX2", 8) != 0)
+        return false;
+
+    ins.read((char*)&last, sizeof(last));
+    ins.read((char*)&entries, sizeof(entries));
+    return (bool)ins;
+}
+
+bool IndexFile::read_entry(std::istream& ins, uint32_t key_length, std::string& key,
+                           uint32_t& count, jmiller::Vector<std::size_t>& recnos)
+{
+    uint64_t recno;
+    uint32_t sum;
+    uint32_t hash;
+
+    // A key never holds more than a record does, so a longer
+    // length means the entry is garbage
+    if (key_length > (uint32_t)Page::SIZE)
+        return false;
+
+    key.resize(key_length);
+    recnos.clear();
+
+    if ((key_length > 0 && !ins.read(&key[0], key_length)) ||
+        !ins.read((char*)&count, sizeof(count)))
+        return false;
+
+    hash = checksum(2166136261u, &key_length, sizeof(key_length));
+    hash = checksum(hash, key.data(), key_length);
+    hash = checksum(hash, &count, sizeof(count));
+
+    for (uint32_t i = 0; i < (count & ~REMOVED); i++)
+    {
+        if (!ins.read((char*)&recno, sizeof(recno)))
+            return false;
+
+        hash = checksum(hash, &recno, sizeof(recno));
+        recnos.push_back(recno);
+    }
+
+    if (!ins.read((char*)&sum, sizeof(sum)))
+        return false;
+
+    return sum == hash;
+}
+
+uint32_t IndexFile::checksum(uint32_t hash, const void* data, std::size_t length)
+{
+    // FNV-1a, carried on from hash
+    const uint8_t* bytes;
+    bytes = (const uint8_t*)data;
+
+    for (std::size_t i = 0; i < length; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+
+    return hash;
+}
+
+void IndexFile::write_entry(FILE* file, const std::string& key,
+                            const jmiller::Vector<std::size_t>& recnos, bool removed)
+{
+    uint32_t key_length;
+    uint32_t count;
+    uint64_t recno;
+    uint32_t hash;
+
+    key_length = key.size();
+    count = recnos.size();
+    count = removed ? (count | REMOVED) : count;
+
+    hash = checksum(2166136261u, &key_length, sizeof(key_length));
+    hash = checksum(hash, key.data(), key_length);
+    hash = checksum(hash, &count, sizeof(count));
+
+    fwrite(&key_length, sizeof(key_length), 1, file);
+    fwrite(key.data(), 1, key_length, file);
+    fwrite(&count, sizeof(count), 1, file);
+
+    for (uint32_t i = 0; i < recnos.size(); i++)
+    {
+        recno = recnos[i];
+        hash = checksum(hash, &recno, sizeof(recno));
+        fwrite(&recno, sizeof(recno), 1, file);
+    }
+
+    // The checksum tells a whole entry from one cut short
+    fwrite(&hash, sizeof(hash), 1, file);
+}
+
+#endif
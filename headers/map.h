@@ -14,6 +14,8 @@ CLASSES CONTAINED:
     Map:
         a class for storing key value pairs
         using a BTree as the underlying structure.
+        Its nodes come from Alloc, NodePool unless
+        given another (see node_pool.h).
 
     Pair: 
         a struct to store the key, value pair stored in
@@ -23,6 +25,12 @@ CONSTRUCTOR:
     Map()
         Postcondition: An empty map has been constructed
 
+    Map(Map<K, V>&& other)
+        Postcondition: The Map holds the pairs of other, which is
+                       empty.  The tree of other is handed over
+                       rather than copied.  Assigning from an
+                       rvalue does the same.
+
 ACCESSORS:
     int size() const
         Postcondition: The number of elements in the Map
@@ -34,7 +42,8 @@ ACCESSORS:
 
     V& operator[](const K& key) 
         Postcondition: A reference to the value paired with
-                       key has been returned.
+                       key has been returned.  If there was no
+                       pair with key one has been created.
 
     
     V& at(const K& key) *** has const version ***
@@ -44,6 +53,12 @@ ACCESSORS:
         Postcondition: A bool indicating the existance of the pair with
                        target in the Map.
 
+    V* find(const K& key)
+        Postcondition: A pointer to the value paired with key has been
+                       returned, or NULL if there is none.  Unlike
+                       contains() followed by [], the tree is only
+                       walked once.
+
     V get(const K& key)
         Postcondition: Returns a non-reference value of the pair with key
 
@@ -60,6 +75,11 @@ MUTATORS:
     void clear()
         Postcondition: The Map no contains no entries.    
 
+    void bulk_load(const jmiller::Vector<Pair<K, V> >& pairs)
+        Precondition: pairs is sorted by key with no key repeated.
+        Postcondition: The Map holds exactly pairs.  The tree is built
+                       bottom up instead of by inserting each pair.
+
 
 
 */
@@ -72,6 +92,8 @@ MUTATORS:
 #include <iostream>
 #include <iomanip>
 #include <cstdlib>
+#include <utility>
+#include "./vector.h"
 #include "./BPTree.h"
 
 template <typename K, typename V>
@@ -122,11 +144,11 @@ struct Pair{
     }
 };
 
-template< typename K, typename V>
+template <typename K, typename V, template <class> class Alloc = NodePool>
 class Map
 {
 public:
-    typedef BPTree<Pair<K, V> > map_base;
+    typedef BPTree<Pair<K, V>, BPTreeOrder<Pair<K, V> >::MINIMUM, Alloc> map_base;
 
     class Iterator
     {
@@ -147,7 +169,7 @@ public:
             ++(this->_it);
             return *this;            
         }
-        Pair<K, V> operator *()
+        const Pair<K, V>& operator *()
         {
             return *_it;
         }
@@ -165,6 +187,11 @@ public:
     };
 
     Map();
+    Map(const Map<K, V, Alloc>& other);
+    Map(Map<K, V, Alloc>&& other);
+
+    Map<K, V, Alloc>& operator =(const Map<K, V, Alloc>& rhs);
+    Map<K, V, Alloc>& operator =(Map<K, V, Alloc>&& rhs);
 
     int size() const { return key_count; }
     bool empty() const { return map.empty(); }
@@ -173,18 +200,20 @@ public:
     V& operator[](const K& key);
     V& at(const K& key);
     const V& at(const K& key) const;
+    V* find(const K& key);
 
 //  Modifiers
     void create_key(const K& k);
     void insert(const K& k, const V& v);
     void erase(const K& key);
     void clear();
+    void bulk_load(const jmiller::Vector<Pair<K, V> >& pairs);
     V get(const K& key);
 
 //  Operations:
     bool contains(const Pair<K, V>& target) const;
 
-    friend std::ostream& operator<<(std::ostream& outs, const Map<K, V>& print_me){
+    friend std::ostream& operator<<(std::ostream& outs, const Map<K, V, Alloc>& print_me){
         outs << print_me.map << std::endl;
         return outs;
     }
@@ -198,90 +227,141 @@ public:
 private:
     
     int key_count;
-    BPTree<Pair<K, V> > map;
+    map_base map;
 };
 
-template<typename K, typename V>
-Map<K, V>::Map()
+template<typename K, typename V, template <class> class Alloc>
+Map<K, V, Alloc>::Map()
 {
     key_count = 0;
 }
 
-template<typename K, typename V>
-V& Map<K, V>:: operator[](const K& key)
+template<typename K, typename V, template <class> class Alloc>
+Map<K, V, Alloc>::Map(const Map<K, V, Alloc>& other)
+    : key_count(other.key_count), map(other.map)
 {
-    return map.get(Pair<K, V>(key)).value;
 }
 
-template<typename K, typename V>
-V& Map<K, V>::at(const K& key) 
+template<typename K, typename V, template <class> class Alloc>
+Map<K, V, Alloc>::Map(Map<K, V, Alloc>&& other)
+    : key_count(other.key_count), map(std::move(other.map))
+{
+    other.key_count = 0;
+}
+
+template<typename K, typename V, template <class> class Alloc>
+Map<K, V, Alloc>& Map<K, V, Alloc>::operator =(const Map<K, V, Alloc>& rhs)
+{
+    key_count = rhs.key_count;
+    map = rhs.map;
+    return *this;
+}
+
+template<typename K, typename V, template <class> class Alloc>
+Map<K, V, Alloc>& Map<K, V, Alloc>::operator =(Map<K, V, Alloc>&& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    key_count = rhs.key_count;
+    map = std::move(rhs.map);
+    rhs.key_count = 0;
+    return *this;
+}
+
+template<typename K, typename V, template <class> class Alloc>
+V& Map<K, V, Alloc>:: operator[](const K& key)
+{
+    return map.get_or_insert(Pair<K, V>(key)).value;
+}
+
+template<typename K, typename V, template <class> class Alloc>
+V& Map<K, V, Alloc>::at(const K& key) 
 {
     return map.get(Pair<K, V>(key)).value;
 }
 
-template<typename K, typename V>
-const V& Map<K, V>::at(const K& key) const
+template<typename K, typename V, template <class> class Alloc>
+const V& Map<K, V, Alloc>::at(const K& key) const
 {
     return map.get(Pair<K, V>(key)).value;
 }
 
-template<typename K, typename V>
-void Map<K, V>::create_key(const K& k)
+template<typename K, typename V, template <class> class Alloc>
+V* Map<K, V, Alloc>::find(const K& key)
+{
+    Pair<K, V>* pair;
+    pair = map.find(Pair<K, V>(key));
+
+    return pair != NULL ? &pair->value : NULL;
+}
+
+template<typename K, typename V, template <class> class Alloc>
+void Map<K, V, Alloc>::create_key(const K& k)
 {
     map.insert(Pair<K, V>(k));
 }
 
-template<typename K, typename V>
-void Map<K, V>::insert(const K& key, const V& value)
+template<typename K, typename V, template <class> class Alloc>
+void Map<K, V, Alloc>::insert(const K& key, const V& value)
 {
     map.insert(Pair<K, V>(key, value));
 }
 
-template<typename K, typename V>
-void Map<K, V>::erase(const K& key)
+template<typename K, typename V, template <class> class Alloc>
+void Map<K, V, Alloc>::erase(const K& key)
 {
     map.remove(Pair<K, V>(key));
 }
 
-template<typename K, typename V>
-void Map<K, V>::clear()
+template<typename K, typename V, template <class> class Alloc>
+void Map<K, V, Alloc>::clear()
 {
     map.clear_tree();
     key_count = 0;
 }
 
-template<typename K, typename V>
-V Map<K, V>::get(const K& key)
+template<typename K, typename V, template <class> class Alloc>
+void Map<K, V, Alloc>::bulk_load(const jmiller::Vector<Pair<K, V> >& pairs)
+{
+    if (pairs.size() == 0)
+        map.clear_tree();
+    else
+        map.bulk_load(&pairs[0], pairs.size());
+}
+
+template<typename K, typename V, template <class> class Alloc>
+V Map<K, V, Alloc>::get(const K& key)
 {
     return map.get(Pair<K, V>(key)).value;
 }
 
-template<typename K, typename V>
-bool Map<K, V>::contains(const Pair<K, V>& target) const
+template<typename K, typename V, template <class> class Alloc>
+bool Map<K, V, Alloc>::contains(const Pair<K, V>& target) const
 {
     return map.contains(target);
 }
 
-template<typename K, typename V>
-typename Map<K, V>::Iterator Map<K, V>::begin()
+template<typename K, typename V, template <class> class Alloc>
+typename Map<K, V, Alloc>::Iterator Map<K, V, Alloc>::begin()
 {
     return Iterator(map.begin());
 }
 
-template<typename K, typename V>
-typename Map<K, V>::Iterator Map<K, V>::end()
+template<typename K, typename V, template <class> class Alloc>
+typename Map<K, V, Alloc>::Iterator Map<K, V, Alloc>::end()
 {
     return Iterator(map.end());
 }
 
-template<typename K, typename V>
-typename Map<K, V>::Iterator Map<K, V>::upper_bound(const K& key)
+template<typename K, typename V, template <class> class Alloc>
+typename Map<K, V, Alloc>::Iterator Map<K, V, Alloc>::upper_bound(const K& key)
 {
     return Iterator(map.upper_bound(Pair<K, V>(key)));
 }
 
-template<typename K, typename V>
-typename Map<K, V>::Iterator Map<K, V>::lower_bound(const K& key)
+template<typename K, typename V, template <class> class Alloc>
+typename Map<K, V, Alloc>::Iterator Map<K, V, Alloc>::lower_bound(const K& key)
 {
     return Iterator(map.lower_bound(Pair<K, V>(key)));
 }
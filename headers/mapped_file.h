@@ -0,0 +1,216 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: mapped_file.h
+
+CLASS PROVIDED: MappedFile
+    Maps a whole file into memory read only so its bytes
+    can be used directly without a seek and read for every
+    access.  Uses mmap on POSIX systems and a file mapping
+    object on Windows.
+
+VALUE SEMANTICS:
+    A MappedFile owns its mapping so it can't be copied.
+
+CONSTRUCTORS:
+    MappedFile()
+        Postcondition: A MappedFile with nothing mapped has been created.
+
+ACCESSORS:
+    bool is_open() const
+        Postcondition: A bool indicating if a file is mapped has been
+                       returned.
+
+    const char* data() const
+        Postcondition: A pointer to the first byte of the mapped file
+                       has been returned.  NULL if nothing is mapped.
+
+    long size() const
+        Postcondition: The number of bytes mapped has been returned.
+
+MUTATORS:
+    bool open(const std::string& file_name)
+        Postcondition: Any previous mapping has been closed and the
+                       current contents of file_name have been mapped.
+                       Returns false if the file couldn't be mapped.
+
+    void close()
+        Postcondition: The mapping has been released.
+
+    void will_need(long offset, long length)
+        Postcondition: The operating system has been told the bytes from
+                       offset on will be read soon, so it can start
+                       reading them in.  Does nothing on Windows.
+
+*/
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdlib>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+class MappedFile
+{
+public:
+    // CONSTRUCTORS
+    MappedFile() : map_data(NULL), map_size(0) {}
+
+    // DESTRUCTOR
+    ~MappedFile() { close(); }
+
+    // ACCESSORS
+    bool is_open() const { return map_data != NULL; }
+    const char* data() const { return map_data; }
+    long size() const { return map_size; }
+
+    // MUTATORS
+    bool open(const std::string& file_name);
+    void close();
+    void will_need(long offset, long length);
+
+private:
+    const char* map_data;
+    long map_size;
+
+    // A MappedFile can't be copied
+    MappedFile(const MappedFile& other);
+    MappedFile& operator =(const MappedFile& rhs);
+};
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& file_name)
+{
+    HANDLE file;
+    HANDLE mapping;
+    LARGE_INTEGER file_size;
+
+    close();
+
+    file = CreateFileA(file_name.c_str(), GENERIC_READ,
+                       FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (mapping != NULL)
+    {
+        map_data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        map_size = (long)file_size.QuadPart;
+    }
+
+    // The view keeps the file mapped after the handles are closed
+    if (mapping != NULL)
+        CloseHandle(mapping);
+    CloseHandle(file);
+
+    if (map_data == NULL)
+        map_size = 0;
+
+    return map_data != NULL;
+}
+
+void MappedFile::close()
+{
+    if (map_data != NULL)
+        UnmapViewOfFile(map_data);
+
+    map_data = NULL;
+    map_size = 0;
+}
+
+void MappedFile::will_need(long offset, long length)
+{
+}
+
+#else
+
+bool MappedFile::open(const std::string& file_name)
+{
+    int fd;
+    struct stat file_info;
+    void* mapped;
+
+    close();
+
+    fd = ::open(file_name.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &file_info) != 0 || file_info.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    mapped = mmap(NULL, file_info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    // The mapping stays valid after the file is closed
+    ::close(fd);
+
+    if (mapped == MAP_FAILED)
+        return false;
+
+    map_data = (const char*)mapped;
+    map_size = file_info.st_size;
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (map_data != NULL)
+        munmap((void*)map_data, map_size);
+
+    map_data = NULL;
+    map_size = 0;
+}
+
+void MappedFile::will_need(long offset, long length)
+{
+    long start;
+
+    if (map_data == NULL || offset >= map_size)
+        return;
+
+    if (offset + length > map_size)
+        length = map_size - offset;
+
+    // madvise needs an address on a boundary of the
+    // system's pages, which the mapping starts on
+    start = offset - offset % sysconf(_SC_PAGESIZE);
+    madvise((void*)(map_data + start), length + (offset - start), MADV_WILLNEED);
+}
+
+#endif
+
+#endif
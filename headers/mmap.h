@@ -14,6 +14,8 @@ CLASSES CONTAINED:
     MMap:
         a class for storing key value pairs
         using a BTree as the underlying structure.
+        Its nodes come from Alloc, NodePool unless
+        given another (see node_pool.h).
 
     MPair: 
         a struct to store the key, value pair stored in
@@ -23,6 +25,12 @@ CONSTRUCTOR:
     MMap()
         Postcondition: An empty MMap has been constructed
 
+    MMap(MMap<K, V>&& other)
+        Postcondition: The MMap holds the pairs of other, which is
+                       empty.  The tree of other is handed over
+                       rather than copied.  Assigning from an
+                       rvalue does the same.
+
 ACCESSORS:
     int size() const
         Postcondition: The number of elements in the MMap
@@ -56,6 +64,11 @@ MUTATORS:
     void clear()
         Postcondition: The MMap no contains no entries.    
 
+    void bulk_load(const jmiller::Vector<MPair<K, V> >& pairs)
+        Precondition: pairs is sorted by key with no key repeated.
+        Postcondition: The MMap holds exactly pairs.  The tree is built
+                       bottom up instead of by inserting each pair.
+
 */
 #ifndef MMAP_H
 #define MMAP_H
@@ -63,6 +76,7 @@ MUTATORS:
 #include <iostream>
 #include <cstdlib>
 #include <iomanip>
+#include <utility>
 #include "./vector.h"
 #include "./BPTree.h"
 
@@ -124,11 +138,11 @@ struct MPair{
 
 };
 
-template <typename K, typename V>
+template <typename K, typename V, template <class> class Alloc = NodePool>
 class MMap
 {
 public:
-    typedef BPTree<MPair<K, V> > map_base;
+    typedef BPTree<MPair<K, V>, BPTreeOrder<MPair<K, V> >::MINIMUM, Alloc> map_base;
 
     class Iterator
     {
@@ -149,7 +163,7 @@ public:
             ++this->_it;
             return *this;            
         }
-        MPair<K, V> operator *()
+        const MPair<K, V>& operator *()
         {
             return *_it;
         }
@@ -167,6 +181,11 @@ public:
     };
 
     MMap();
+    MMap(const MMap<K, V, Alloc>& other);
+    MMap(MMap<K, V, Alloc>&& other);
+
+    MMap<K, V, Alloc>& operator =(const MMap<K, V, Alloc>& rhs);
+    MMap<K, V, Alloc>& operator =(MMap<K, V, Alloc>&& rhs);
 
 //  Capacity
     int size() const;
@@ -181,6 +200,7 @@ public:
     void insert(const K& k, const V& v);
     void erase(const K& key);
     void clear();
+    void bulk_load(const jmiller::Vector<MPair<K, V> >& pairs);
 
 //  Operations:
     bool contains(const K& key) const ;
@@ -195,18 +215,18 @@ public:
     Iterator lower_bound(const K& key);
 
 
-    friend std::ostream& operator<<(std::ostream& outs, const MMap<K, V>& print_me){
+    friend std::ostream& operator<<(std::ostream& outs, const MMap<K, V, Alloc>& print_me){
         outs << print_me.mmap << std::endl;
         return outs;
     }
 
 // private:
     int key_count;
-    BPTree<MPair<K, V> > mmap;
+    map_base mmap;
 };
 
-template<typename K, typename V>
-void MMap<K, V>::create_key(const K& k)
+template<typename K, typename V, template <class> class Alloc>
+void MMap<K, V, Alloc>::create_key(const K& k)
 {
     if (mmap.contains(k))
         return;
@@ -214,8 +234,8 @@ void MMap<K, V>::create_key(const K& k)
         mmap.insert(MPair<K, V>(k));
 }
 
-template<typename K, typename V>
-void MMap<K, V>::insert(const K& k, const V& v)
+template<typename K, typename V, template <class> class Alloc>
+void MMap<K, V, Alloc>::insert(const K& k, const V& v)
 {
     if (mmap.contains(k))
         mmap.get(k).value_list.push_back(v);
@@ -223,81 +243,116 @@ void MMap<K, V>::insert(const K& k, const V& v)
         mmap.insert(MPair<K, V>(k, v)); 
 }
 
-template<typename K, typename V>
-void MMap<K, V>::erase(const K& key)
+template<typename K, typename V, template <class> class Alloc>
+void MMap<K, V, Alloc>::erase(const K& key)
 {
     mmap.remove(MPair<K, V>(key));
 }
 
-template<typename K, typename V>
-void MMap<K, V>::clear()
+template<typename K, typename V, template <class> class Alloc>
+void MMap<K, V, Alloc>::clear()
 {
     mmap.clear_tree();
 }
 
-template<typename K, typename V>
-bool MMap<K, V>::contains(const K& key) const
+template<typename K, typename V, template <class> class Alloc>
+void MMap<K, V, Alloc>::bulk_load(const jmiller::Vector<MPair<K, V> >& pairs)
+{
+    if (pairs.size() == 0)
+        mmap.clear_tree();
+    else
+        mmap.bulk_load(&pairs[0], pairs.size());
+}
+
+template<typename K, typename V, template <class> class Alloc>
+bool MMap<K, V, Alloc>::contains(const K& key) const
 {
     return mmap.contains(MPair<K, V>(key));
 }
 
-template<typename K, typename V>
-MMap<K, V>::MMap()
+template<typename K, typename V, template <class> class Alloc>
+MMap<K, V, Alloc>::MMap()
 {
     key_count = 0;
 }
 
-template<typename K, typename V>
-int MMap<K, V>::size() const
+template<typename K, typename V, template <class> class Alloc>
+MMap<K, V, Alloc>::MMap(const MMap<K, V, Alloc>& other)
+    : key_count(other.key_count), mmap(other.mmap)
+{
+}
+
+template<typename K, typename V, template <class> class Alloc>
+MMap<K, V, Alloc>::MMap(MMap<K, V, Alloc>&& other)
+    : key_count(other.key_count), mmap(std::move(other.mmap))
+{
+    other.key_count = 0;
+}
+
+template<typename K, typename V, template <class> class Alloc>
+MMap<K, V, Alloc>& MMap<K, V, Alloc>::operator =(const MMap<K, V, Alloc>& rhs)
+{
+    key_count = rhs.key_count;
+    mmap = rhs.mmap;
+    return *this;
+}
+
+template<typename K, typename V, template <class> class Alloc>
+MMap<K, V, Alloc>& MMap<K, V, Alloc>::operator =(MMap<K, V, Alloc>&& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    key_count = rhs.key_count;
+    mmap = std::move(rhs.mmap);
+    rhs.key_count = 0;
+    return *this;
+}
+
+template<typename K, typename V, template <class> class Alloc>
+int MMap<K, V, Alloc>::size() const
 {
     return key_count;
 }
 
-template<typename K, typename V>
-bool MMap<K, V>::empty() const
+template<typename K, typename V, template <class> class Alloc>
+bool MMap<K, V, Alloc>::empty() const
 {
-    return key_count == 0;
+    return mmap.empty();
 }
 
-template<typename K, typename V>
-const jmiller::Vector<V>& MMap<K, V>::operator[](const K& key) const
+template<typename K, typename V, template <class> class Alloc>
+const jmiller::Vector<V>& MMap<K, V, Alloc>::operator[](const K& key) const
 {
     return mmap.get(MPair<K, V>(key)).value_list;
 }
 
-template<typename K, typename V>
-jmiller::Vector<V>& MMap<K, V>::operator[](const K& key)
+template<typename K, typename V, template <class> class Alloc>
+jmiller::Vector<V>& MMap<K, V, Alloc>::operator[](const K& key)
 {
-    if (mmap.contains(MPair<K, V>(key)))
-        return mmap.get(MPair<K, V>(key)).value_list;
-    else
-    {
-        this->create_key(key);
-        return mmap.get(MPair<K, V>(key)).value_list;
-    }
-    
+    return mmap.get_or_insert(MPair<K, V>(key)).value_list;
 }
 
-template<typename K, typename V>
-typename MMap<K, V>::Iterator MMap<K, V>::begin()
+template<typename K, typename V, template <class> class Alloc>
+typename MMap<K, V, Alloc>::Iterator MMap<K, V, Alloc>::begin()
 {
     return Iterator(mmap.begin());
 }
 
-template<typename K, typename V>
-typename MMap<K, V>::Iterator MMap<K, V>::end()
+template<typename K, typename V, template <class> class Alloc>
+typename MMap<K, V, Alloc>::Iterator MMap<K, V, Alloc>::end()
 {
     return Iterator(mmap.end());
 }
 
-template<typename K, typename V>
-typename MMap<K, V>::Iterator MMap<K, V>::upper_bound(const K& key)
+template<typename K, typename V, template <class> class Alloc>
+typename MMap<K, V, Alloc>::Iterator MMap<K, V, Alloc>::upper_bound(const K& key)
 {
     return Iterator(mmap.upper_bound(MPair<K, V>(key)));
 }
 
-template<typename K, typename V>
-typename MMap<K, V>::Iterator MMap<K, V>::lower_bound(const K& key)
+template<typename K, typename V, template <class> class Alloc>
+typename MMap<K, V, Alloc>::Iterator MMap<K, V, Alloc>::lower_bound(const K& key)
 {
     return Iterator(mmap.lower_bound(MPair<K, V>(key)));
 }
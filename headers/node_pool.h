@@ -0,0 +1,161 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: node_pool.h
+
+TEMPLATE CLASSES PROVIDED: NodePool<Node>, HeapNodes<Node>
+    Where the nodes of a BPTree or BTree come from.  A tree
+    is given one of these as its Alloc template parameter
+    and its root keeps one for the whole tree.  Either hands
+    out raw memory for one Node at a time, which the tree
+    constructs the node in and destroys the node in before
+    giving it back.
+
+    NodePool:
+        Carves nodes out of slabs which hold many nodes each,
+        so a tree's nodes are packed together in memory and
+        making one is usually a pointer bump.  A node given
+        back goes on a free list and is the next one handed
+        out.  The slabs are only freed by release(), all at
+        once, which the tree does when it's cleared.  Each
+        slab holds twice as many nodes as the last, up to
+        MAX_SLAB_NODES, so a small tree doesn't hold much.
+
+    HeapNodes:
+        Makes each node with its own call to operator new,
+        the way the trees did before they had pools.
+
+CONSTRUCTORS:
+    NodePool()
+    HeapNodes()
+        Postcondition: A pool without any nodes has been created.
+
+MUTATORS:
+    void* allocate()
+        Postcondition: Memory for one Node has been returned.
+
+    void deallocate(void* node)
+        Precondition: node came from allocate() on this pool and the
+                      Node in it has been destroyed.
+        Postcondition: The memory of node can be handed out again.
+
+    void release()
+        Precondition: Every Node from the pool has been destroyed.
+        Postcondition: The memory of every node has been freed.
+
+*/
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <iostream>
+#include <cstdlib>
+#include <new>
+#include "./vector.h"
+
+template <class Node>
+class NodePool
+{
+public:
+    // STATIC MEMBER CONSTANTS
+    static const int MIN_SLAB_NODES = 4;
+    static const int MAX_SLAB_NODES = 256;
+
+    // CONSTRUCTORS
+    NodePool() : free_list(NULL), slab_nodes(0), slab_used(0) {}
+
+    // DESTRUCTOR
+    ~NodePool() { release(); }
+
+    // MUTATORS
+    void* allocate();
+    void deallocate(void* node);
+    void release();
+
+private:
+    // A node on the free list holds the next one
+    // in the memory the node was in
+    struct FreeNode
+    {
+        FreeNode* next;
+    };
+
+    jmiller::Vector<char*> slabs;
+    FreeNode* free_list;
+    int slab_nodes;
+    int slab_used;
+
+    // A pool belongs to one tree, so it isn't copied
+    NodePool(const NodePool& other);
+    NodePool& operator =(const NodePool& rhs);
+};
+
+template <class Node>
+void* NodePool<Node>::allocate()
+{
+    FreeNode* node;
+    char* slab;
+
+    if (free_list != NULL)
+    {
+        node = free_list;
+        free_list = free_list->next;
+        return node;
+    }
+
+    // The last slab is used up so a bigger one is made
+    if (slabs.size() == 0 || slab_used == slab_nodes)
+    {
+        slab_nodes = slab_nodes == 0 ? MIN_SLAB_NODES : slab_nodes * 2;
+
+        if (slab_nodes > MAX_SLAB_NODES)
+            slab_nodes = MAX_SLAB_NODES;
+
+        slab = (char*)::operator new(slab_nodes * sizeof(Node));
+        slabs.push_back(slab);
+        slab_used = 0;
+    }
+
+    return slabs[slabs.size() - 1] + sizeof(Node) * slab_used++;
+}
+
+template <class Node>
+void NodePool<Node>::deallocate(void* node)
+{
+    FreeNode* freed;
+
+    freed = (FreeNode*)node;
+    freed->next = free_list;
+    free_list = freed;
+}
+
+template <class Node>
+void NodePool<Node>::release()
+{
+    for (int i = 0; i < slabs.size(); i++)
+        ::operator delete(slabs[i]);
+
+    slabs.clear();
+    free_list = NULL;
+    slab_nodes = 0;
+    slab_used = 0;
+}
+
+template <class Node>
+class HeapNodes
+{
+public:
+    // MUTATORS
+    void* allocate() { return ::operator new(sizeof(Node)); }
+    void deallocate(void* node) { ::operator delete(node); }
+    void release() {}
+};
+
+#endif
@@ -0,0 +1,454 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: page.h
+
+CLASS PROVIDED: Page
+    A fixed size block of a table file laid out as a slotted
+    page.  Variable length records are packed from the end of
+    the page towards the front while a slot directory, which
+    holds the offset and length of each record, grows from
+    the front towards the back.
+
+PAGE LAYOUT:
+    [slot count : 2 bytes][free end : 2 bytes]
+    [slot 0 offset : 2 bytes][slot 0 length : 2 bytes] ...
+    ... free space ...
+    [record n] ... [record 1][record 0]
+
+RECORD IDS:
+    A record is identified by the page it lives on and its
+    slot in that page.  Both are packed into a single number
+    so record ids can be stored in the indices like the old
+    record numbers: rid = page number << SLOT_BITS | slot.
+    Record ids never change once a record has been written.
+
+DELETED RECORDS:
+    A deleted record's slot is kept as a tombstone with an
+    offset and length of 0 so the slots after it keep their
+    numbers.  The bytes it used are taken back by compact(),
+    which packs the records left against the end of the page
+    without changing their slots, and a tombstone can be
+    given to a new record by reuse().
+
+CONSTRUCTORS:
+    Page()
+        Postcondition: An empty page with no slots has been created.
+
+ACCESSORS:
+    int slot_count() const
+        Postcondition: The number of slots in the page has been returned.
+
+    int free_space() const
+        Postcondition: The number of bytes available for a new record,
+                       including its slot, has been returned.
+
+    bool get(int slot, const char*& data, int& length) const
+        Postcondition: If slot holds a record, data points at it inside
+                       the page, length holds its size and true is returned.
+
+    bool is_dead(int slot) const
+        Postcondition: A bool indicating if slot is a tombstone has been
+                       returned.
+
+    int dead_count() const
+        Postcondition: The number of tombstones has been returned.
+
+MUTATORS:
+    int insert(const char* data, int length)
+        Postcondition: If there was room the record has been copied into
+                       the page and its slot returned.  Otherwise -1.
+
+    bool update(int slot, const char* data, int length)
+        Precondition: length is the same as the record already in slot.
+        Postcondition: The record in slot has been overwritten with data.
+
+    bool put(int slot, const char* data, int length)
+        Postcondition: slot holds the record, whatever it held before.
+                       Slots up to it are added as tombstones if the
+                       page doesn't have them.  Returns false if the
+                       record doesn't fit.
+
+    bool replace(int slot, const char* data, int length)
+        Postcondition: slot holds the record in place of the one it
+                       held, which may have been a different length.
+                       Returns false and leaves the page alone if the
+                       record doesn't fit or there's no such slot.
+
+    int reuse(const char* data, int length)
+        Postcondition: The record has been put in the first tombstone
+                       and its slot returned.  Returns -1 if the page
+                       has no tombstone or no room for it.
+
+    bool erase(int slot)
+        Postcondition: slot is a tombstone.  Returns false if it didn't
+                       hold a record.
+
+    void compact()
+        Postcondition: The space of every tombstone has been freed.  Each
+                       record keeps its slot.
+
+    void truncate(int slots)
+        Precondition: slots is no more than slot_count().
+        Postcondition: Only the first slots records are left in the page.
+
+FILE FUNCTIONS:
+    bool read(std::fstream& ins, long page_no)
+        Postcondition: The page has been filled from page_no of the file.
+                       Returns false if the file has no such page.
+
+    void write(std::fstream& outs, long page_no)
+        Postcondition: The page has been written as page_no of the file.
+
+    static long count(std::fstream& ins)
+        Postcondition: The number of pages in the file has been returned.
+
+    static const Page* at(const char* data)
+        Precondition: data points at SIZE bytes laid out as a page, such
+                      as a page of a memory mapped table file.
+        Postcondition: The bytes have been returned as a Page without
+                       being copied.
+
+*/
+#ifndef PAGE_H
+#define PAGE_H
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+class Page
+{
+public:
+    // STATIC MEMBER CONSTANTS
+    static const int SIZE = 4096;
+    static const int HEADER_SIZE = 4;
+    static const int SLOT_SIZE = 4;
+    static const int MAX_RECORD = SIZE - HEADER_SIZE - SLOT_SIZE;
+    static const int SLOT_BITS = 12;
+
+    // CONSTRUCTORS
+    Page();
+
+    // ACCESSORS
+    int slot_count() const { return get_u16(0); }
+    int free_space() const;
+    bool get(int slot, const char*& data, int& length) const;
+    bool is_dead(int slot) const;
+    int dead_count() const;
+
+    // MUTATORS
+    int insert(const char* data, int length);
+    bool update(int slot, const char* data, int length);
+    bool put(int slot, const char* data, int length);
+    bool replace(int slot, const char* data, int length);
+    int reuse(const char* data, int length);
+    bool erase(int slot);
+    void compact();
+    void truncate(int slots);
+
+    // FILE FUNCTIONS
+    bool read(std::fstream& ins, long page_no);
+    void write(std::fstream& outs, long page_no);
+    static long count(std::fstream& ins);
+    static const Page* at(const char* data) { return (const Page*)data; }
+
+    // RECORD ID FUNCTIONS
+    static long rid(long page_no, int slot) { return (page_no << SLOT_BITS) | slot; }
+    static long page_of(long rid) { return rid >> SLOT_BITS; }
+    static int slot_of(long rid) { return rid & ((1 << SLOT_BITS) - 1); }
+
+private:
+    // The buffer must be the only member so that
+    // at() can treat any SIZE bytes as a Page
+    char buffer[SIZE];
+
+    int get_u16(int pos) const;
+    void set_u16(int pos, int value);
+    int free_end() const { return get_u16(2); }
+    int used_bytes() const;
+};
+
+Page::Page()
+{
+    memset(buffer, 0, SIZE);
+    set_u16(0, 0);
+    set_u16(2, SIZE);
+}
+
+int Page::free_space() const
+{
+    return free_end() - (HEADER_SIZE + slot_count() * SLOT_SIZE);
+}
+
+bool Page::get(int slot, const char*& data, int& length) const
+{
+    if (slot < 0 || slot >= slot_count() || is_dead(slot))
+        return false;
+
+    data = buffer + get_u16(HEADER_SIZE + slot * SLOT_SIZE);
+    length = get_u16(HEADER_SIZE + slot * SLOT_SIZE + 2);
+
+    return true;
+}
+
+bool Page::is_dead(int slot) const
+{
+    return slot >= 0 && slot < slot_count() && get_u16(HEADER_SIZE + slot * SLOT_SIZE) == 0;
+}
+
+int Page::dead_count() const
+{
+    int dead;
+    dead = 0;
+
+    for (int slot = 0; slot < slot_count(); slot++)
+        if (is_dead(slot))
+            dead++;
+
+    return dead;
+}
+
+int Page::insert(const char* data, int length)
+{
+    int slot;
+    int offset;
+
+    if (length + SLOT_SIZE > free_space() || slot_count() >= (1 << SLOT_BITS))
+        return -1;
+
+    // The record is packed against the records already in the
+    // page and a new slot pointing at it is added to the directory
+    slot = slot_count();
+    offset = free_end() - length;
+
+    memcpy(buffer + offset, data, length);
+
+    set_u16(HEADER_SIZE + slot * SLOT_SIZE, offset);
+    set_u16(HEADER_SIZE + slot * SLOT_SIZE + 2, length);
+    set_u16(0, slot + 1);
+    set_u16(2, offset);
+
+    return slot;
+}
+
+bool Page::update(int slot, const char* data, int length)
+{
+    const char* old_data;
+    int old_length;
+
+    if (!get(slot, old_data, old_length) || old_length != length)
+        return false;
+
+    memcpy(buffer + get_u16(HEADER_SIZE + slot * SLOT_SIZE), data, length);
+    return true;
+}
+
+bool Page::put(int slot, const char* data, int length)
+{
+    int offset;
+
+    if (slot < 0 || slot >= (1 << SLOT_BITS))
+        return false;
+
+    // Whatever the slot held is dropped first, and any
+    // slots missing before it are added as tombstones
+    erase(slot);
+
+    while (slot_count() <= slot)
+    {
+        if (free_space() < SLOT_SIZE)
+            compact();
+
+        if (free_space() < SLOT_SIZE)
+            return false;
+
+        set_u16(HEADER_SIZE + slot_count() * SLOT_SIZE, 0);
+        set_u16(HEADER_SIZE + slot_count() * SLOT_SIZE + 2, 0);
+        set_u16(0, slot_count() + 1);
+    }
+
+    if (length > free_space())
+        compact();
+
+    if (length > free_space())
+        return false;
+
+    offset = free_end() - length;
+    memcpy(buffer + offset, data, length);
+
+    set_u16(HEADER_SIZE + slot * SLOT_SIZE, offset);
+    set_u16(HEADER_SIZE + slot * SLOT_SIZE + 2, length);
+    set_u16(2, offset);
+
+    return true;
+}
+
+bool Page::replace(int slot, const char* data, int length)
+{
+    const char* old_data;
+    int old_length;
+
+    if (slot < 0 || slot >= slot_count())
+        return false;
+
+    if (!get(slot, old_data, old_length))
+        old_length = 0;
+
+    // A record no longer than the one it replaces is
+    // written over it.  A longer one is only put in
+    // the page if it fits once the old one is gone.
+    if (old_length > 0 && length <= old_length)
+    {
+        memcpy(buffer + get_u16(HEADER_SIZE + slot * SLOT_SIZE), data, length);
+        set_u16(HEADER_SIZE + slot * SLOT_SIZE + 2, length);
+        return true;
+    }
+
+    if (SIZE - HEADER_SIZE - slot_count() * SLOT_SIZE - (used_bytes() - old_length) < length)
+        return false;
+
+    return put(slot, data, length);
+}
+
+int Page::reuse(const char* data, int length)
+{
+    int slot;
+
+    for (slot = 0; slot < slot_count() && !is_dead(slot); slot++)
+        ;
+
+    // Compacting the page is only worth it if the
+    // record will fit once it's done
+    if (slot == slot_count() ||
+        SIZE - HEADER_SIZE - slot_count() * SLOT_SIZE - used_bytes() < length)
+        return -1;
+
+    if (!put(slot, data, length))
+        return -1;
+
+    return slot;
+}
+
+bool Page::erase(int slot)
+{
+    if (slot < 0 || slot >= slot_count() || is_dead(slot))
+        return false;
+
+    // The last record packed can give its bytes
+    // straight back to the free space
+    if (get_u16(HEADER_SIZE + slot * SLOT_SIZE) == free_end())
+        set_u16(2, free_end() + get_u16(HEADER_SIZE + slot * SLOT_SIZE + 2));
+
+    set_u16(HEADER_SIZE + slot * SLOT_SIZE, 0);
+    set_u16(HEADER_SIZE + slot * SLOT_SIZE + 2, 0);
+
+    return true;
+}
+
+void Page::compact()
+{
+    char packed[SIZE];
+    const char* data;
+    int length;
+    int end;
+
+    // Every record is copied against the end of a
+    // second buffer in slot order, then the directory
+    // is pointed at the new places
+    end = SIZE;
+
+    for (int slot = 0; slot < slot_count(); slot++)
+        if (get(slot, data, length))
+        {
+            end -= length;
+            memcpy(packed + end, data, length);
+            set_u16(HEADER_SIZE + slot * SLOT_SIZE, end);
+        }
+
+    memcpy(buffer + end, packed + end, SIZE - end);
+    set_u16(2, end);
+}
+
+void Page::truncate(int slots)
+{
+    const char* data;
+    int length;
+    int end;
+
+    // A record which was replaced may have been moved
+    // nearer the free space than the ones after it, so
+    // the free space starts at the nearest record kept
+    end = SIZE;
+
+    for (int slot = 0; slot < slots; slot++)
+        if (get(slot, data, length) && data - buffer < end)
+            end = data - buffer;
+
+    set_u16(2, end);
+    set_u16(0, slots);
+}
+
+bool Page::read(std::fstream& ins, long page_no)
+{
+    ins.clear();
+    ins.seekg(page_no * SIZE, std::ios_base::beg);
+    ins.read(buffer, SIZE);
+
+    return ins.gcount() == SIZE;
+}
+
+void Page::write(std::fstream& outs, long page_no)
+{
+    outs.clear();
+    outs.seekp(page_no * SIZE, std::ios_base::beg);
+    outs.write(buffer, SIZE);
+}
+
+long Page::count(std::fstream& ins)
+{
+    ins.clear();
+    ins.seekg(0, std::ios_base::end);
+
+    return (long)ins.tellg() / SIZE;
+}
+
+int Page::used_bytes() const
+{
+    const char* data;
+    int length;
+    int used;
+    used = 0;
+
+    for (int slot = 0; slot < slot_count(); slot++)
+        if (get(slot, data, length))
+            used += length;
+
+    return used;
+}
+
+int Page::get_u16(int pos) const
+{
+    uint16_t value;
+    memcpy(&value, buffer + pos, sizeof(value));
+    return value;
+}
+
+void Page::set_u16(int pos, int value)
+{
+    uint16_t v;
+    v = value;
+    memcpy(buffer + pos, &v, sizeof(v));
+}
+
+#endif
@@ -12,6 +12,50 @@
  The Parser class takes as input an SQL command, determines
  its validity, and provides a tree which breaks the command
  into its separate parts.
+
+ A field in a make table command may be followed by its
+ type, i.e. make table emp fields name, salary int64,
+ code char(4).  The types are kept in the tree under
+ "types", one for each field, with varchar for fields
+ which weren't given one.
+
+ make columnar table <table> fields ... makes a table
+ which stores each field in a file of its own.  The tree
+ holds "columnar" under "storage" for one.
+
+ load <table> from <file> reads the records of a table
+ from a CSV or TSV file.  A file name with punctuation in
+ it must be quoted, i.e. load emp from "data/emp.csv".
+
+ delete from <table> where ... deletes the records which
+ meet the conditions, which are parsed the same way as a
+ select's.  Without a where every record is deleted.
+
+ compact <table> (or compact table <table>) takes back the
+ space of a table's deleted records.
+
+ update <table> set <field> = <value>, ... where ... gives
+ the fields of the records which meet the conditions new
+ values.  The fields are kept under "fields" and their
+ values under "values", in the same order.
+
+ create bitmap index on <table>(<field>) gives a field an
+ index of the kind named before "index", which is tree,
+ bitmap or hash (see column_index.h), or tree if no kind is
+ named.  The kind is kept under "index", the table under
+ "table" and the field under "fields".  drop index on
+ <table>(<field>) takes the field's index away.
+
+ A condition may use != as well as the other relational
+ operators.
+
+ Negative numbers and dates, i.e. -12 or 2020-01-05, may be
+ given without quotes.  Any other value with a '-' in it
+ must be quoted.
+
+ parse_tree() returns the tree by const reference, so it
+ can be asked for each part of a command without copying
+ the tree each time.
  
  */
 
@@ -37,7 +81,7 @@ class Parser
 public:
     Parser(char* s);
 
-    MMap<std::string, std::string> parse_tree();
+    const MMap<std::string, std::string>& parse_tree() const { return ptree; }
     bool get_parse_tree();
     void init_ptree();
     int get_column(std::string key);
@@ -71,7 +115,18 @@ private:
                     SYMBOL,
                     VALUES,
                     FIELDS,
-                    TABLE };
+                    TABLE,
+                    LPAREN,
+                    RPAREN,
+                    LOAD,
+                    COLUMNAR,
+                    DELETE,
+                    COMPACT,
+                    UPDATE,
+                    SET,
+                    INDEX,
+                    ON,
+                    DROP };
 };
 
 Parser::Parser(char* s)
@@ -104,13 +159,34 @@ bool Parser::get_parse_tree()
         case 1:
         case 20:
         case 30:
+        case 40:
+        case 50:
+        case 55:
+        case 60:
+        case 80:
             ptree["command"] += string;
             break;
         case 2:
         case 11:
-        case 24:
         case 34:
+        case 63:
+        case 75:
+            ptree["fields"] += string;
+            break;
+        case 24:
             ptree["fields"] += string;
+            ptree["types"] += "varchar";
+            break;
+        case 26:
+            // Replaces the default type of the last field
+            ptree["types"][ptree["types"].size() - 1] = string;
+            break;
+        case 27:
+        case 28:
+        case 29:
+            // The rest of a type like int64 or char(10)
+            // comes in as separate tokens
+            ptree["types"][ptree["types"].size() - 1] += string;
             break;
         case 3:
         case 4:
@@ -120,10 +196,44 @@ bool Parser::get_parse_tree()
         case 31:
         case 33:
         case 35:
+        case 42:
+        case 51:
+        case 56:
+        case 62:
+        case 66:
+        case 71:
+        case 72:
+        case 74:
+        case 76:
+            break;
+        case 64:
+            // A field can only be set equal to a value
+            if (string != "=")
+                return false;
+            break;
+        case 65:
+            ptree["values"] += string;
+            break;
+        case 70:
+            ptree["index"] += string;
+            break;
+        case 77:
+            ptree["index"] += std::string("tree");
+            break;
+        case 43:
+            ptree["file"] += string;
+            break;
+        case 44:
+            ptree["storage"] += string;
             break;
         case  5:
         case 22:
         case 32:
+        case 41:
+        case 52:
+        case 57:
+        case 61:
+        case 73:
             ptree["table"] += string;
             break;
         case 6:
@@ -150,9 +260,14 @@ void Parser::init_ptree()
                              "table",
                              "fields",
                              "where",
-                             "conditions" };
-
-    for (int i = 0; i < 5; i++)
+                             "conditions",
+                             "types",
+                             "file",
+                             "storage",
+                             "values",
+                             "index" };
+
+    for (int i = 0; i < 10; i++)
         ptree.create_key(strs[i]);
 }
 
@@ -190,7 +305,7 @@ void Parser::tokenize_string()
             }
             input_queue.push(str);
         }
-        else if (t.token_str() == ">" || t.token_str() == "<")
+        else if (t.token_str() == ">" || t.token_str() == "<" || t.token_str() == "!")
         {
             str = t.token_str();
             t = Token();
@@ -237,12 +352,41 @@ void Parser::make_p_table()
     // MAKE / CREATE MACHINE
     adj_table[0][CREATE] = 20;
     adj_table[20][TABLE] = 21;
+    adj_table[20][COLUMNAR] = 44;
+    adj_table[44][TABLE] = 21;
     adj_table[21][SYMBOL] = 22;
     adj_table[22][FIELDS] = 23;
     adj_table[23][SYMBOL] = 24;
     adj_table[24][ZERO] = 1; // success state
     adj_table[24][COMMA] = 25;
     adj_table[25][SYMBOL] = 24;
+    adj_table[24][SYMBOL] = 26;
+    adj_table[26][ZERO] = 1; // success state
+    adj_table[26][COMMA] = 25;
+    adj_table[26][SYMBOL] = 27;
+    adj_table[26][LPAREN] = 28;
+    adj_table[27][ZERO] = 1; // success state
+    adj_table[27][COMMA] = 25;
+    adj_table[28][SYMBOL] = 29;
+    adj_table[29][RPAREN] = 27;
+
+    // CREATE INDEX MACHINE
+    // The kind of index comes between create and index
+    adj_table[20][SYMBOL] = 70;
+    adj_table[20][INDEX] = 77;
+    adj_table[70][INDEX] = 71;
+    adj_table[77][ON] = 72;
+    adj_table[71][ON] = 72;
+    adj_table[72][SYMBOL] = 73;
+    adj_table[73][LPAREN] = 74;
+    adj_table[74][SYMBOL] = 75;
+    adj_table[75][RPAREN] = 76;
+    adj_table[76][ZERO] = 1; // success state
+
+    // DROP INDEX MACHINE
+    // The rest goes through the create index machine's states
+    adj_table[0][DROP] = 80;
+    adj_table[80][INDEX] = 71;
 
     // INSERT MACHINE
     adj_table[0][INSERT] = 30;
@@ -253,11 +397,46 @@ void Parser::make_p_table()
     adj_table[34][ZERO] = 1; // success state
     adj_table[34][COMMA] = 35;
     adj_table[35][SYMBOL] = 34;
+
+    // LOAD MACHINE
+    adj_table[0][LOAD] = 40;
+    adj_table[40][SYMBOL] = 41;
+    adj_table[41][FROM] = 42;
+    adj_table[42][SYMBOL] = 43;
+    adj_table[43][ZERO] = 1; // success state
+
+    // DELETE MACHINE
+    // The conditions go through the select machine's states
+    adj_table[0][DELETE] = 50;
+    adj_table[50][FROM] = 51;
+    adj_table[51][SYMBOL] = 52;
+    adj_table[52][ZERO] = 1; // success state
+    adj_table[52][WHERE] = 6;
+
+    // COMPACT MACHINE
+    adj_table[0][COMPACT] = 55;
+    adj_table[55][TABLE] = 56;
+    adj_table[55][SYMBOL] = 57;
+    adj_table[56][SYMBOL] = 57;
+    adj_table[57][ZERO] = 1; // success state
+
+    // UPDATE MACHINE
+    // The conditions go through the select machine's states
+    adj_table[0][UPDATE] = 60;
+    adj_table[60][SYMBOL] = 61;
+    adj_table[61][SET] = 62;
+    adj_table[62][SYMBOL] = 63;
+    adj_table[63][RELATIONAL] = 64;
+    adj_table[64][SYMBOL] = 65;
+    adj_table[65][ZERO] = 1; // success state
+    adj_table[65][COMMA] = 66;
+    adj_table[65][WHERE] = 6;
+    adj_table[66][SYMBOL] = 63;
 }
 
 void Parser::build_keyword_map()
 {
-    std::string words[20] = { "create", 
+    std::string words[32] = { "create", 
                               "make", 
                               "select", 
                               "insert", 
@@ -276,9 +455,21 @@ void Parser::build_keyword_map()
                               "*",
                               "values",
                               "fields",
-                              "table" };
-
-    for (int i = 0; i < 20; i++)
+                              "table",
+                              "(",
+                              ")",
+                              "load",
+                              "columnar",
+                              "delete",
+                              "compact",
+                              "update",
+                              "set",
+                              "index",
+                              "on",
+                              "!=",
+                              "drop" };
+
+    for (int i = 0; i < 32; i++)
         keywords_map.create_key(words[i]);
 
     keywords_map[words[0]] = CREATE;
@@ -301,12 +492,19 @@ void Parser::build_keyword_map()
     keywords_map[words[17]] = VALUES;
     keywords_map[words[18]] = FIELDS;
     keywords_map[words[19]] = TABLE;
+    keywords_map[words[20]] = LPAREN;
+    keywords_map[words[21]] = RPAREN;
+    keywords_map[words[22]] = LOAD;
+    keywords_map[words[23]] = COLUMNAR;
+    keywords_map[words[24]] = DELETE;
+    keywords_map[words[25]] = COMPACT;
+    keywords_map[words[26]] = UPDATE;
+    keywords_map[words[27]] = SET;
+    keywords_map[words[28]] = INDEX;
+    keywords_map[words[29]] = ON;
+    keywords_map[words[30]] = RELATIONAL;
+    keywords_map[words[31]] = DROP;
 
 }
 
-MMap<std::string, std::string> Parser::parse_tree()
-{
-    return this->ptree;
-}
-
 #endif
\ No newline at end of file
@@ -0,0 +1,1000 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: row_set.h
+
+CLASS PROVIDED: RowSet
+    A compressed set of record ids, used for the posting
+    lists of the column indices and for the rows a condition
+    picks out.
+
+    The ids are split into chunks of 65536 by their high
+    bits and each chunk which has any is kept in a container
+    of the low 16 bits, whichever of these is smallest:
+
+        ARRAY   the ids in order, 2 bytes each.  Used for
+                up to ARRAY_MAX ids.
+        BITSET  a bit for every id in the chunk, 8K bytes.
+        RUNS    the first and last id of each run of
+                consecutive ids, 4 bytes a run.
+
+    Ids added one at a time go into an array until it's full
+    and then a bitset.  optimize() picks the smallest of the
+    three for each container, which is done once a whole set
+    has been built.  AND and OR work a container at a time,
+    so chunks only one side has are skipped or copied whole.
+
+    The rows of a columnar table are numbered 1, 2, 3, ...
+    so a chunk can be full and any container may be used.
+    The rid of a row table's record is its page number
+    shifted past Page::SLOT_BITS with its slot below, so a
+    chunk spans 16 pages and the slots past the last record
+    of each page are never used.  Unless the records are
+    only a few bytes long a chunk holds fewer than ARRAY_MAX
+    of them, so their sets only take the ARRAY and RUNS
+    forms, and a run ends at the last record of its page.
+
+VALUE SEMANTICS:
+    The copy constructor and assignment operator may be used
+    with this class.  Each container is held by pointer so an
+    empty or small set only allocates what it uses.
+
+CONSTRUCTORS:
+    RowSet()
+        Postcondition: An empty set has been created.
+
+    RowSet(const jmiller::Vector<std::size_t>& rows)
+        Postcondition: A set of the ids in rows has been created.  rows
+                       doesn't need to be in order.
+
+    RowSet(const RowSet& other)
+        Postcondition: The set is a copy of other with containers of its
+                       own.
+
+    RowSet(RowSet&& other)
+        Postcondition: The set holds the containers of other, which is
+                       empty.  Assigning from an rvalue does the same.
+
+ACCESSORS:
+    std::size_t size() const
+        Postcondition: The number of ids in the set has been returned.
+
+    bool empty() const
+        Postcondition: A bool indicating if the set has no ids has been
+                       returned.
+
+    bool contains(std::size_t row) const
+        Postcondition: A bool indicating if row is in the set has been
+                       returned.
+
+    jmiller::Vector<std::size_t> rows() const
+        Postcondition: The ids in the set have been returned in order.
+
+MUTATORS:
+    void add(std::size_t row)
+        Postcondition: row is in the set.
+
+    void remove(std::size_t row)
+        Postcondition: row is not in the set.
+
+    void optimize()
+        Postcondition: Each container is in the form which takes the
+                       least space.
+
+    void clear()
+        Postcondition: The set is empty.
+
+    RowSet& operator |=(const RowSet& rhs)
+        Postcondition: Every id in rhs has been added to the set.
+
+FRIENDS:
+    RowSet operator &(const RowSet& lhs, const RowSet& rhs)
+        Postcondition: The ids in both sets have been returned.
+
+    RowSet operator |(const RowSet& lhs, const RowSet& rhs)
+        Postcondition: The ids in either set have been returned.
+
+*/
+#ifndef ROW_SET_H
+#define ROW_SET_H
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <stdint.h>
+#include "./vector.h"
+
+class RowSet
+{
+public:
+    // STATIC MEMBER CONSTANTS
+    static const int CHUNK_BITS = 16;
+    static const int ARRAY_MAX = 4096;
+    static const int WORDS = 4096;
+    static const int GALLOP_RATIO = 32;
+
+    // CONSTRUCTORS
+    RowSet() : row_count(0) {}
+    RowSet(const jmiller::Vector<std::size_t>& rows);
+    RowSet(const RowSet& other);
+    RowSet(RowSet&& other);
+
+    // ASSIGNMENT OPERATOR
+    RowSet& operator =(const RowSet& rhs);
+    RowSet& operator =(RowSet&& rhs);
+
+    // DESTRUCTOR
+    ~RowSet();
+
+    // ACCESSORS
+    std::size_t size() const { return row_count; }
+    bool empty() const { return row_count == 0; }
+    bool contains(std::size_t row) const;
+    jmiller::Vector<std::size_t> rows() const;
+
+    // MUTATORS
+    void add(std::size_t row);
+    void remove(std::size_t row);
+    void optimize();
+    void clear();
+    RowSet& operator |=(const RowSet& rhs);
+
+    // FRIENDS
+    friend RowSet operator &(const RowSet& lhs, const RowSet& rhs);
+    friend RowSet operator |(const RowSet& lhs, const RowSet& rhs);
+
+    friend std::ostream& operator <<(std::ostream& outs, const RowSet& print_me)
+    {
+        jmiller::Vector<std::size_t> ids;
+
+        ids = print_me.rows();
+        outs << "[  ";
+
+        for (int i = 0; i < ids.size(); i++)
+            outs << ids[i] << "  ";
+
+        outs << "]";
+        return outs;
+    }
+
+private:
+    static const int ARRAY = 0;
+    static const int BITSET = 1;
+    static const int RUNS = 2;
+
+    // A chunk with a few ids, like most chunks of the RowSet
+    // of a value held by one or two records, keeps them
+    // inside its Container rather than on the heap
+    static const int INLINE_IDS = 4;
+    typedef jmiller::Vector<uint16_t, INLINE_IDS> Ids;
+
+    // The ids of one chunk.  data holds the sorted low
+    // bits of an ARRAY, the 16 bit words of a BITSET or
+    // the first and last id of each run of RUNS.
+    struct Container
+    {
+        std::size_t key;
+        int kind;
+        int count;
+        Ids data;
+
+        Container(std::size_t k = 0) : key(k), kind(ARRAY), count(0) {}
+    };
+
+    jmiller::Vector<Container*> containers;
+    std::size_t row_count;
+
+    int find_container(std::size_t key) const;
+    void insert_container(int index, Container* container);
+    void erase_container(int index);
+
+    static bool has(const Container& c, uint16_t low);
+    static bool add_to(Container& c, uint16_t low);
+    static bool remove_from(Container& c, uint16_t low);
+    static void set_bits(const Container& c, uint16_t* words);
+    static void build(Container& c, const uint16_t* words, int kind);
+    static int count_bits(uint16_t word);
+    static int count_runs(const uint16_t* words);
+    static Container intersect(const Container& a, const Container& b);
+    static Container unite(const Container& a, const Container& b);
+    static int first_run_after(const Container& c, uint16_t low);
+    static int gallop(const Ids& values, int from, uint16_t target);
+    static void insert_values(Ids& values, int index, const uint16_t* items, int count);
+    static void erase_values(Ids& values, int index, int count);
+};
+
+RowSet::RowSet(const jmiller::Vector<std::size_t>& rows)
+{
+    jmiller::Vector<std::size_t> sorted;
+
+    row_count = 0;
+    sorted = rows;
+
+    // Added in order each id goes on the end of
+    // the last container without moving any
+    if (sorted.size() > 0)
+        std::sort(&sorted[0], &sorted[0] + sorted.size());
+
+    for (int i = 0; i < sorted.size(); i++)
+        add(sorted[i]);
+}
+
+RowSet::RowSet(const RowSet& other)
+{
+    row_count = other.row_count;
+
+    for (int i = 0; i < other.containers.size(); i++)
+        containers.push_back(new Container(*other.containers[i]));
+}
+
+RowSet::RowSet(RowSet&& other)
+    : containers(std::move(other.containers)), row_count(other.row_count)
+{
+    other.row_count = 0;
+}
+
+RowSet& RowSet::operator =(const RowSet& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    clear();
+    row_count = rhs.row_count;
+
+    for (int i = 0; i < rhs.containers.size(); i++)
+        containers.push_back(new Container(*rhs.containers[i]));
+
+    return *this;
+}
+
+RowSet& RowSet::operator =(RowSet&& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    clear();
+    containers = std::move(rhs.containers);
+    row_count = rhs.row_count;
+    rhs.row_count = 0;
+
+    return *this;
+}
+
+RowSet::~RowSet()
+{
+    for (int i = 0; i < containers.size(); i++)
+        delete containers[i];
+}
+
+bool RowSet::contains(std::size_t row) const
+{
+    int i;
+
+    i = find_container(row >> CHUNK_BITS);
+
+    return i < containers.size() && containers[i]->key == row >> CHUNK_BITS &&
+           has(*containers[i], row & 0xFFFF);
+}
+
+jmiller::Vector<std::size_t> RowSet::rows() const
+{
+    jmiller::Vector<std::size_t> ids;
+    std::size_t base;
+
+    ids.reserve(row_count);
+
+    for (int i = 0; i < containers.size(); i++)
+    {
+        const Container& c = *containers[i];
+        base = c.key << CHUNK_BITS;
+
+        if (c.kind == ARRAY)
+        {
+            for (int j = 0; j < c.data.size(); j++)
+                ids.push_back(base | c.data[j]);
+        }
+        else if (c.kind == BITSET)
+        {
+            for (int w = 0; w < WORDS; w++)
+                for (int bit = 0; c.data[w] >> bit != 0; bit++)
+                    if (c.data[w] & (1 << bit))
+                        ids.push_back(base | (w * 16 + bit));
+        }
+        else
+        {
+            for (int r = 0; r < c.data.size(); r += 2)
+                for (std::size_t low = c.data[r]; low <= c.data[r + 1]; low++)
+                    ids.push_back(base | low);
+        }
+    }
+
+    return ids;
+}
+
+void RowSet::add(std::size_t row)
+{
+    std::size_t key;
+    int i;
+
+    key = row >> CHUNK_BITS;
+    i = find_container(key);
+
+    // Ids usually come in order so a new
+    // container goes at the end
+    if (i == containers.size() || containers[i]->key != key)
+        insert_container(i, new Container(key));
+
+    if (add_to(*containers[i], row & 0xFFFF))
+        row_count++;
+}
+
+void RowSet::remove(std::size_t row)
+{
+    std::size_t key;
+    int i;
+
+    key = row >> CHUNK_BITS;
+    i = find_container(key);
+
+    if (i == containers.size() || containers[i]->key != key)
+        return;
+
+    if (!remove_from(*containers[i], row & 0xFFFF))
+        return;
+
+    row_count--;
+
+    if (containers[i]->count == 0)
+        erase_container(i);
+}
+
+void RowSet::optimize()
+{
+    uint16_t words[WORDS];
+    int array_size;
+    int runs_size;
+    int runs;
+    int kind;
+
+    for (int i = 0; i < containers.size(); i++)
+    {
+        Container& c = *containers[i];
+
+        // The runs are counted in whatever form the
+        // container is in, so one which stays as it
+        // is costs nothing to check
+        if (c.kind == ARRAY)
+        {
+            runs = c.count > 0 ? 1 : 0;
+
+            for (int j = 1; j < c.count; j++)
+                if (c.data[j] != c.data[j - 1] + 1)
+                    runs++;
+        }
+        else if (c.kind == BITSET)
+            runs = count_runs(&c.data[0]);
+        else
+            runs = c.data.size() / 2;
+
+        // Sizes in 16 bit words.  An array can't
+        // hold more than ARRAY_MAX ids.
+        array_size = c.count <= ARRAY_MAX ? c.count : WORDS + 1;
+        runs_size = runs * 2;
+
+        if (runs_size < array_size && runs_size < WORDS)
+            kind = RUNS;
+        else if (array_size <= WORDS)
+            kind = ARRAY;
+        else
+            kind = BITSET;
+
+        if (kind == c.kind)
+            continue;
+
+        memset(words, 0, sizeof(words));
+        set_bits(c, words);
+        build(c, words, kind);
+    }
+}
+
+void RowSet::clear()
+{
+    for (int i = 0; i < containers.size(); i++)
+        delete containers[i];
+
+    containers.clear();
+    row_count = 0;
+}
+
+RowSet& RowSet::operator |=(const RowSet& rhs)
+{
+    int i;
+
+    // Each container of rhs is merged into the one with
+    // the same key, found by a binary search, so ORing
+    // many small sets into a large one stays cheap
+    for (int j = 0; j < rhs.containers.size(); j++)
+    {
+        const Container& c = *rhs.containers[j];
+        i = find_container(c.key);
+
+        if (i < containers.size() && containers[i]->key == c.key)
+        {
+            row_count -= containers[i]->count;
+            *containers[i] = unite(*containers[i], c);
+        }
+        else
+            insert_container(i, new Container(c));
+
+        row_count += containers[i]->count;
+    }
+
+    return *this;
+}
+
+RowSet operator &(const RowSet& lhs, const RowSet& rhs)
+{
+    RowSet anded;
+    RowSet::Container c;
+    int i;
+    int j;
+
+    i = 0;
+    j = 0;
+
+    // Only chunks both sets have can have ids in common
+    while (i < lhs.containers.size() && j < rhs.containers.size())
+    {
+        if (lhs.containers[i]->key < rhs.containers[j]->key)
+            i++;
+        else if (rhs.containers[j]->key < lhs.containers[i]->key)
+            j++;
+        else
+        {
+            c = RowSet::intersect(*lhs.containers[i], *rhs.containers[j]);
+
+            if (c.count > 0)
+            {
+                anded.containers.push_back(new RowSet::Container(c));
+                anded.row_count += c.count;
+            }
+
+            i++;
+            j++;
+        }
+    }
+
+    return anded;
+}
+
+RowSet operator |(const RowSet& lhs, const RowSet& rhs)
+{
+    RowSet ored;
+
+    ored = lhs;
+    ored |= rhs;
+
+    return ored;
+}
+
+int RowSet::find_container(std::size_t key) const
+{
+    int low;
+    int high;
+    int mid;
+
+    // Checks the last container first since
+    // that's where new ids usually go
+    high = containers.size();
+
+    if (high == 0 || containers[high - 1]->key < key)
+        return high;
+
+    low = 0;
+
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+
+        if (containers[mid]->key < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+void RowSet::insert_container(int index, Container* container)
+{
+    containers.push_back(container);
+
+    for (int i = containers.size() - 1; i > index; i--)
+        containers.swap(i, i - 1);
+}
+
+void RowSet::erase_container(int index)
+{
+    for (int i = index; i + 1 < containers.size(); i++)
+        containers.swap(i, i + 1);
+
+    delete containers[containers.size() - 1];
+    containers.pop_back();
+}
+
+bool RowSet::has(const Container& c, uint16_t low)
+{
+    int i;
+
+    if (c.kind == BITSET)
+        return (c.data[low / 16] & (1 << (low % 16))) != 0;
+
+    if (c.kind == ARRAY)
+    {
+        i = std::lower_bound(&c.data[0], &c.data[0] + c.data.size(), low) - &c.data[0];
+        return i < c.data.size() && c.data[i] == low;
+    }
+
+    i = first_run_after(c, low);
+    return i > 0 && low <= c.data[2 * i - 1];
+}
+
+bool RowSet::add_to(Container& c, uint16_t low)
+{
+    uint16_t words[WORDS];
+    uint16_t run[2];
+    int i;
+
+    if (c.kind == ARRAY)
+    {
+        i = std::lower_bound(&c.data[0], &c.data[0] + c.data.size(), low) - &c.data[0];
+
+        if (i < c.data.size() && c.data[i] == low)
+            return false;
+
+        insert_values(c.data, i, &low, 1);
+        c.count++;
+
+        // A full array is turned into a bitset
+        if (c.count > ARRAY_MAX)
+        {
+            memset(words, 0, sizeof(words));
+            set_bits(c, words);
+            build(c, words, BITSET);
+        }
+
+        return true;
+    }
+
+    if (c.kind == BITSET)
+    {
+        if (c.data[low / 16] & (1 << (low % 16)))
+            return false;
+
+        c.data[low / 16] |= (1 << (low % 16));
+        c.count++;
+        return true;
+    }
+
+    // i is the run after low.  low either joins the run
+    // before it, the run after it, both, or starts its own.
+    i = first_run_after(c, low);
+
+    if (i > 0 && low <= c.data[2 * i - 1])
+        return false;
+
+    if (i > 0 && c.data[2 * i - 1] + 1 == low)
+    {
+        c.data[2 * i - 1] = low;
+
+        if (2 * i < c.data.size() && c.data[2 * i] == low + 1)
+        {
+            c.data[2 * i - 1] = c.data[2 * i + 1];
+            erase_values(c.data, 2 * i, 2);
+        }
+    }
+    else if (2 * i < c.data.size() && c.data[2 * i] == low + 1)
+        c.data[2 * i] = low;
+    else
+    {
+        run[0] = low;
+        run[1] = low;
+        insert_values(c.data, 2 * i, run, 2);
+    }
+
+    c.count++;
+
+    // Runs which have broken up take more
+    // space than a bitset
+    if (c.data.size() > WORDS)
+    {
+        memset(words, 0, sizeof(words));
+        set_bits(c, words);
+        build(c, words, BITSET);
+    }
+
+    return true;
+}
+
+bool RowSet::remove_from(Container& c, uint16_t low)
+{
+    uint16_t words[WORDS];
+    uint16_t run[2];
+    int i;
+
+    if (c.kind == ARRAY)
+    {
+        i = std::lower_bound(&c.data[0], &c.data[0] + c.data.size(), low) - &c.data[0];
+
+        if (i == c.data.size() || c.data[i] != low)
+            return false;
+
+        erase_values(c.data, i, 1);
+        c.count--;
+        return true;
+    }
+
+    if (c.kind == BITSET)
+    {
+        if (!(c.data[low / 16] & (1 << (low % 16))))
+            return false;
+
+        c.data[low / 16] &= ~(1 << (low % 16));
+        c.count--;
+
+        // A bitset which has emptied down to half an
+        // array is turned into one.  Waiting for half
+        // keeps a set near the limit from flipping back
+        // and forth as ids come and go.
+        if (c.count <= ARRAY_MAX / 2)
+        {
+            memcpy(words, &c.data[0], sizeof(words));
+            build(c, words, ARRAY);
+        }
+
+        return true;
+    }
+
+    // The run holding low is shortened, dropped
+    // or split in two around it
+    i = first_run_after(c, low) - 1;
+
+    if (i < 0 || low > c.data[2 * i + 1])
+        return false;
+
+    if (c.data[2 * i] == c.data[2 * i + 1])
+        erase_values(c.data, 2 * i, 2);
+    else if (c.data[2 * i] == low)
+        c.data[2 * i] = low + 1;
+    else if (c.data[2 * i + 1] == low)
+        c.data[2 * i + 1] = low - 1;
+    else
+    {
+        run[0] = low + 1;
+        run[1] = c.data[2 * i + 1];
+        c.data[2 * i + 1] = low - 1;
+        insert_values(c.data, 2 * i + 2, run, 2);
+    }
+
+    c.count--;
+    return true;
+}
+
+void RowSet::set_bits(const Container& c, uint16_t* words)
+{
+    if (c.kind == ARRAY)
+    {
+        for (int i = 0; i < c.data.size(); i++)
+            words[c.data[i] / 16] |= (1 << (c.data[i] % 16));
+    }
+    else if (c.kind == BITSET)
+    {
+        for (int w = 0; w < WORDS; w++)
+            words[w] |= c.data[w];
+    }
+    else
+    {
+        for (int r = 0; r < c.data.size(); r += 2)
+            for (int low = c.data[r]; low <= c.data[r + 1]; low++)
+                words[low / 16] |= (1 << (low % 16));
+    }
+}
+
+void RowSet::build(Container& c, const uint16_t* words, int kind)
+{
+    uint16_t run[2];
+    bool in_run;
+    bool set;
+
+    c.data = Ids();
+    c.kind = kind;
+    c.count = 0;
+
+    for (int w = 0; w < WORDS; w++)
+        c.count += count_bits(words[w]);
+
+    if (kind == BITSET)
+    {
+        c.data.reserve(WORDS);
+
+        for (int w = 0; w < WORDS; w++)
+            c.data.push_back(words[w]);
+    }
+    else if (kind == ARRAY)
+    {
+        c.data.reserve(c.count);
+
+        for (int w = 0; w < WORDS; w++)
+            for (int bit = 0; words[w] >> bit != 0; bit++)
+                if (words[w] & (1 << bit))
+                    c.data.push_back(w * 16 + bit);
+    }
+    else
+    {
+        in_run = false;
+
+        for (int low = 0; low <= 0xFFFF; low++)
+        {
+            set = (words[low / 16] & (1 << (low % 16))) != 0;
+
+            if (set && !in_run)
+                run[0] = low;
+            else if (!set && in_run)
+            {
+                run[1] = low - 1;
+                c.data.push_back(run[0]);
+                c.data.push_back(run[1]);
+            }
+
+            in_run = set;
+        }
+
+        if (in_run)
+        {
+            c.data.push_back(run[0]);
+            c.data.push_back(0xFFFF);
+        }
+    }
+}
+
+int RowSet::count_bits(uint16_t word)
+{
+    int count;
+
+    for (count = 0; word != 0; count++)
+        word &= word - 1;
+
+    return count;
+}
+
+int RowSet::count_runs(const uint16_t* words)
+{
+    int runs;
+    uint16_t carry;
+
+    runs = 0;
+    carry = 0;
+
+    // A run starts at every set bit whose
+    // lower neighbour isn't set
+    for (int w = 0; w < WORDS; w++)
+    {
+        runs += count_bits(words[w] & ~((words[w] << 1) | carry));
+        carry = words[w] >> 15;
+    }
+
+    return runs;
+}
+
+RowSet::Container RowSet::intersect(const Container& a, const Container& b)
+{
+    Container anded(a.key);
+    uint16_t words[WORDS];
+    uint16_t other[WORDS];
+    int i;
+    int j;
+
+    // Two arrays are merged.  When one is much shorter
+    // than the other each of its ids is looked for in the
+    // longer one, starting where the last one was found.
+    if (a.kind == ARRAY && b.kind == ARRAY)
+    {
+        const Container& shorter = a.count <= b.count ? a : b;
+        const Container& longer = a.count <= b.count ? b : a;
+
+        i = 0;
+        j = 0;
+
+        if (shorter.count * GALLOP_RATIO < longer.count)
+        {
+            for (i = 0; i < shorter.count && j < longer.count; i++)
+            {
+                j = gallop(longer.data, j, shorter.data[i]);
+
+                if (j < longer.count && longer.data[j] == shorter.data[i])
+                    anded.data.push_back(shorter.data[i]);
+            }
+        }
+        else
+        {
+            while (i < shorter.count && j < longer.count)
+            {
+                if (shorter.data[i] < longer.data[j])
+                    i++;
+                else if (longer.data[j] < shorter.data[i])
+                    j++;
+                else
+                {
+                    anded.data.push_back(shorter.data[i]);
+                    i++;
+                    j++;
+                }
+            }
+        }
+
+        anded.count = anded.data.size();
+        return anded;
+    }
+
+    // An array against anything else keeps
+    // the ids the other one has
+    if (a.kind == ARRAY || b.kind == ARRAY)
+    {
+        const Container& array = a.kind == ARRAY ? a : b;
+        const Container& other_set = a.kind == ARRAY ? b : a;
+
+        for (i = 0; i < array.count; i++)
+            if (has(other_set, array.data[i]))
+                anded.data.push_back(array.data[i]);
+
+        anded.count = anded.data.size();
+        return anded;
+    }
+
+    // Otherwise the bits are ANDed a word at a time
+    memset(words, 0, sizeof(words));
+    memset(other, 0, sizeof(other));
+    set_bits(a, words);
+    set_bits(b, other);
+
+    for (int w = 0; w < WORDS; w++)
+        words[w] &= other[w];
+
+    build(anded, words, BITSET);
+
+    if (anded.count <= ARRAY_MAX)
+        build(anded, words, ARRAY);
+
+    return anded;
+}
+
+RowSet::Container RowSet::unite(const Container& a, const Container& b)
+{
+    Container ored(a.key);
+    uint16_t words[WORDS];
+    int i;
+    int j;
+
+    // Two small arrays are merged into an array
+    if (a.kind == ARRAY && b.kind == ARRAY && a.count + b.count <= ARRAY_MAX)
+    {
+        ored.data.reserve(a.count + b.count);
+        i = 0;
+        j = 0;
+
+        while (i < a.count && j < b.count)
+        {
+            if (a.data[i] < b.data[j])
+                ored.data.push_back(a.data[i++]);
+            else if (b.data[j] < a.data[i])
+                ored.data.push_back(b.data[j++]);
+            else
+            {
+                ored.data.push_back(a.data[i]);
+                i++;
+                j++;
+            }
+        }
+
+        for (; i < a.count; i++)
+            ored.data.push_back(a.data[i]);
+
+        for (; j < b.count; j++)
+            ored.data.push_back(b.data[j]);
+
+        ored.count = ored.data.size();
+        return ored;
+    }
+
+    // Otherwise both are ORed into a bitset
+    memset(words, 0, sizeof(words));
+    set_bits(a, words);
+    set_bits(b, words);
+
+    build(ored, words, BITSET);
+
+    if (ored.count <= ARRAY_MAX)
+        build(ored, words, ARRAY);
+
+    return ored;
+}
+
+int RowSet::first_run_after(const Container& c, uint16_t low)
+{
+    int first;
+    int last;
+    int mid;
+
+    // Binary search over the starts of the runs
+    first = 0;
+    last = c.data.size() / 2;
+
+    while (first < last)
+    {
+        mid = (first + last) / 2;
+
+        if (c.data[2 * mid] <= low)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+
+    return first;
+}
+
+int RowSet::gallop(const Ids& values, int from, uint16_t target)
+{
+    int step;
+    int end;
+
+    if (from >= values.size() || values[from] >= target)
+        return from;
+
+    // Steps twice as far each time until one lands on an
+    // id which isn't less than target, then the last step
+    // is searched
+    step = 1;
+
+    while (from + step < values.size() && values[from + step] < target)
+    {
+        from += step;
+        step *= 2;
+    }
+
+    end = from + step < values.size() ? from + step + 1 : values.size();
+
+    return std::lower_bound(&values[0] + from + 1, &values[0] + end, target) - &values[0];
+}
+
+void RowSet::insert_values(Ids& values, int index, const uint16_t* items, int count)
+{
+    for (int i = 0; i < count; i++)
+        values.push_back(0);
+
+    for (int i = values.size() - 1; i >= index + count; i--)
+        values[i] = values[i - count];
+
+    for (int i = 0; i < count; i++)
+        values[index + i] = items[i];
+}
+
+void RowSet::erase_values(Ids& values, int index, int count)
+{
+    for (int i = index; i + count < values.size(); i++)
+        values[i] = values[i + count];
+
+    for (int i = 0; i < count; i++)
+        values.pop_back();
+}
+
+#endif
@@ -48,6 +48,10 @@ void SQL::run()
 
     std::cout << "-------- SQL ---------\n\n" << std::endl;
 
+    // Every table is found through the catalog, so it's
+    // read once here rather than by each statement
+    Table::open_catalog();
+
     while (!done)
     {
         std::cout << "> ";
@@ -60,6 +64,10 @@ void SQL::run()
         else
             run_command(command);
     }
+
+    // A group commit only forces the log when a statement
+    // commits, so whatever the last ones left is forced now
+    Table::sync();
 }
 
 void SQL::run_command(char* command)
@@ -72,18 +80,70 @@ void SQL::run_command(char* command)
         if (p.parse_tree()["command"][0] == "make" || 
                 p.parse_tree()["command"][0] == "create")
         {
-            Table t(p.parse_tree()["table"][0], p.parse_tree()["fields"]);
+            if (p.parse_tree()["index"].size() > 0)
+            {
+                Table t(p.parse_tree()["table"][0]);
+
+                if (t.create_index(p.parse_tree()["fields"][0], p.parse_tree()["index"][0]))
+                    std::cout << "Created " << p.parse_tree()["index"][0] << " index on "
+                              << p.parse_tree()["table"][0] << "("
+                              << p.parse_tree()["fields"][0] << ")." << std::endl;
+            }
+            else if (Table::valid_types(p.parse_tree()["types"]))
+                Table t(p.parse_tree()["table"][0], p.parse_tree()["fields"],
+                        p.parse_tree()["types"], p.parse_tree()["storage"].size() > 0);
+        }
+        else if (p.parse_tree()["command"][0] == "load")
+        {
+            Table t(p.parse_tree()["table"][0]);
+            std::size_t loaded;
+            loaded = t.load(p.parse_tree()["file"][0]);
+            std::cout << "Loaded " << loaded << " records." << std::endl;
         }
         else if(p.parse_tree()["command"][0] == "insert")
         {
             Table t(p.parse_tree()["table"][0]);
             t.insert_into(p.parse_tree()["fields"]);
         }
+        else if (p.parse_tree()["command"][0] == "delete")
+        {
+            Table t(p.parse_tree()["table"][0]);
+            std::size_t deleted;
+            deleted = t.delete_from(p.parse_tree()["conditions"]);
+            std::cout << "Deleted " << deleted << " records." << std::endl;
+        }
+        else if (p.parse_tree()["command"][0] == "update")
+        {
+            Table t(p.parse_tree()["table"][0]);
+            std::size_t updated;
+            updated = t.update(p.parse_tree()["fields"], p.parse_tree()["values"],
+                               p.parse_tree()["conditions"]);
+            std::cout << "Updated " << updated << " records." << std::endl;
+        }
+        else if (p.parse_tree()["command"][0] == "compact")
+        {
+            Table t(p.parse_tree()["table"][0]);
+            t.compact();
+        }
+        else if (p.parse_tree()["command"][0] == "drop")
+        {
+            Table t(p.parse_tree()["table"][0]);
+
+            if (t.drop_index(p.parse_tree()["fields"][0]))
+                std::cout << "Dropped the index on " << p.parse_tree()["table"][0] << "("
+                          << p.parse_tree()["fields"][0] << ")." << std::endl;
+        }
         else
         {
             Table t(p.parse_tree()["table"][0]);
-            std::cout << t.select(p.parse_tree()["fields"], p.parse_tree()["conditions"]) << std::endl;
+            Table::Cursor selected = t.select(p.parse_tree()["fields"], p.parse_tree()["conditions"]);
+            std::cout << selected << std::endl;
         }
+
+        // Commits the command's log records according to the
+        // commit policy.  The pages it changed stay in the
+        // buffer pool until their table is checkpointed.
+        Table::commit();
     }
 }
 
@@ -113,6 +173,8 @@ void SQL::run_batch(char* command)
             }
             file.getline(line, 256);
         }
+
+        Table::sync();
     }
 } 
 #endif
\ No newline at end of file
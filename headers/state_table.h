@@ -54,7 +54,9 @@ void _make_table(int table[][COLS])
     // Allows for integers, decimal, and comma denoted i.e. 123,456,789
     // or both (123,456,789.123).  Doesn't allow for invalid numbers such as
     // 123.123.123 or 123.123,123.
-    // Not able to do negative numbers yet.
+    // A '-' between digits is kept in the number so a date
+    // such as 2020-01-05 is one token, and one before a digit
+    // makes a negative number (see below).
     mark_range(table, MACHINE_START, '0', '9', NUMBER_MACHINE);
     mark_success(table, NUMBER_MACHINE);
     mark_range(table, NUMBER_MACHINE, '0', '9', NUMBER_MACHINE);
@@ -66,12 +68,19 @@ void _make_table(int table[][COLS])
     mark_range(table, NUMBER_MACHINE + 2, '0', '9', NUMBER_MACHINE + 3);
     mark_range(table, NUMBER_MACHINE + 3, '0', '9', NUMBER_MACHINE + 3);
     mark_success(table, NUMBER_MACHINE + 3);
+    mark_char(table, '-', NUMBER_MACHINE, NUMBER_MACHINE + 1);
 
     // PUNCUATION MACHINE
     // Takes each occurance of a punctuation character as its own token
     mark_cstr(table, PUNCT, MACHINE_START, PUNCT_MACHINE);
     mark_success(table, PUNCT_MACHINE);
 
+    // A '-' followed by a digit starts a negative number
+    // instead.  On its own it's still taken as one character.
+    mark_char(table, '-', MACHINE_START, NUMBER_MACHINE + 4);
+    mark_fail(table, NUMBER_MACHINE + 4);
+    mark_range(table, NUMBER_MACHINE + 4, '0', '9', NUMBER_MACHINE);
+
     // WHITESPACE MACHINE
     // each occurance of a whitespace character will be taken as its own
     // token
@@ -0,0 +1,239 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: tombstones.h
+
+CLASS PROVIDED: Tombstones
+    A bitmap of the deleted rows of a columnar table.  The
+    rows of a columnar table are numbered by where they are
+    in the column files (see column_file.h), so a deleted
+    row is left in the columns and its bit is set instead.
+
+    Slot 0 of each page of the file holds the bits of ROWS
+    rows, the first page holding rows 0 to ROWS - 1.  Pages
+    are read and written through the BufferPool so the file
+    is written back when the table is checkpointed.  A table
+    which has never had a row deleted has no pages.
+
+VALUE SEMANTICS:
+    A Tombstones only refers to a file opened by the pool
+    so it can be copied.
+
+CONSTRUCTORS:
+    Tombstones()
+        Postcondition: A Tombstones without a file has been created.
+
+    Tombstones(BufferPool* pool, const std::string& file_name, bool create = false)
+        Postcondition: The file has been opened through pool.  If create
+                       is true it has been created or emptied.
+
+ACCESSORS:
+    bool is_dead(long row) const
+        Postcondition: A bool indicating if row has been deleted has
+                       been returned.
+
+    long count() const
+        Postcondition: The number of deleted rows has been returned.
+
+MUTATORS:
+    bool mark(long row)
+        Postcondition: row is deleted.  Returns false if it already was.
+
+    void truncate(long rows)
+        Postcondition: No row after the first rows is deleted.
+
+*/
+#ifndef TOMBSTONES_H
+#define TOMBSTONES_H
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdint.h>
+#include "./page.h"
+#include "./buffer_pool.h"
+
+class Tombstones
+{
+public:
+    // STATIC MEMBER CONSTANTS
+    static const int BYTES = Page::MAX_RECORD;
+    static const long ROWS = BYTES * 8L;
+
+    // CONSTRUCTORS
+    Tombstones() : pool(NULL), file(-1) {}
+    Tombstones(BufferPool* pool, const std::string& file_name, bool create = false);
+
+    // ACCESSORS
+    bool is_dead(long row) const;
+    long count() const;
+
+    // MUTATORS
+    bool mark(long row);
+    void truncate(long rows);
+
+private:
+    BufferPool* pool;
+    int file;
+};
+
+Tombstones::Tombstones(BufferPool* buffer_pool, const std::string& file_name, bool create)
+{
+    pool = buffer_pool;
+    file = pool->open_file(file_name, create);
+}
+
+bool Tombstones::is_dead(long row) const
+{
+    const Page* page;
+    const char* bits;
+    int length;
+    long page_no;
+    bool dead;
+
+    page_no = row / ROWS;
+
+    // Most tables have no deleted rows and no pages
+    if (file < 0 || row < 0 || page_no >= pool->page_count(file))
+        return false;
+
+    page = pool->read(file, page_no);
+
+    if (page == NULL)
+        return false;
+
+    dead = page->get(0, bits, length) &&
+           (bits[(row % ROWS) / 8] & (1 << (row % 8))) != 0;
+
+    pool->release(file, page_no, page);
+    return dead;
+}
+
+long Tombstones::count() const
+{
+    const Page* page;
+    const char* bits;
+    int length;
+    long page_count;
+    long dead;
+
+    dead = 0;
+    page_count = file < 0 ? 0 : pool->page_count(file);
+
+    for (long page_no = 0; page_no < page_count; page_no++)
+    {
+        page = pool->read(file, page_no);
+
+        if (page != NULL && page->get(0, bits, length))
+            for (int i = 0; i < length; i++)
+                for (int bit = 0; bit < 8; bit++)
+                    if (bits[i] & (1 << bit))
+                        dead++;
+
+        if (page != NULL)
+            pool->release(file, page_no, page);
+    }
+
+    return dead;
+}
+
+bool Tombstones::mark(long row)
+{
+    Page* page;
+    char bits[BYTES];
+    const char* data;
+    int length;
+    long page_no;
+    long new_page_no;
+    bool marked;
+
+    if (file < 0 || row < 0)
+        return false;
+
+    page_no = row / ROWS;
+
+    // Pages of empty bits are added up to the
+    // one the row is in
+    while (pool->page_count(file) <= page_no)
+    {
+        page = pool->new_page(file, new_page_no);
+
+        if (page == NULL)
+            return false;
+
+        memset(bits, 0, BYTES);
+        page->insert(bits, BYTES);
+        pool->unpin(file, new_page_no, true);
+    }
+
+    page = pool->fetch(file, page_no);
+
+    if (page == NULL)
+        return false;
+
+    if (!page->get(0, data, length) || length != BYTES)
+    {
+        pool->unpin(file, page_no, false);
+        return false;
+    }
+
+    memcpy(bits, data, BYTES);
+    marked = (bits[(row % ROWS) / 8] & (1 << (row % 8))) == 0;
+
+    if (marked)
+    {
+        bits[(row % ROWS) / 8] |= (1 << (row % 8));
+        page->update(0, bits, BYTES);
+    }
+
+    pool->unpin(file, page_no, marked);
+    return marked;
+}
+
+void Tombstones::truncate(long rows)
+{
+    Page* page;
+    char bits[BYTES];
+    const char* data;
+    int length;
+    long page_count;
+    long first;
+
+    page_count = file < 0 ? 0 : pool->page_count(file);
+
+    // Clears every bit past rows in the pages
+    // which have any
+    for (long page_no = rows / ROWS; page_no < page_count; page_no++)
+    {
+        page = pool->fetch(file, page_no);
+
+        if (page == NULL)
+            continue;
+
+        if (!page->get(0, data, length) || length != BYTES)
+        {
+            pool->unpin(file, page_no, false);
+            continue;
+        }
+
+        memcpy(bits, data, BYTES);
+        first = page_no * ROWS;
+
+        for (long row = (rows + 1 > first ? rows + 1 : first); row < first + ROWS; row++)
+            bits[(row % ROWS) / 8] &= ~(1 << (row % 8));
+
+        page->update(0, bits, BYTES);
+        pool->unpin(file, page_no, true);
+    }
+}
+
+#endif
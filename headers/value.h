@@ -0,0 +1,465 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: value.h
+
+CLASSES PROVIDED:
+    FieldType:
+        The type of a table column.  A column is one of
+
+            int64        a 64 bit signed integer
+            double       a double precision decimal
+            date         a date written YYYY-MM-DD
+            char(n)      a string of exactly n bytes
+            varchar      a string of any length
+            varchar(n)   a string of at most n bytes
+            dict         a string stored as a code in the
+                         column's dictionary (see dictionary.h)
+
+        Columns made without a type are varchar.  A dict
+        column suits one which repeats a few strings, such as
+        a department name.
+
+    Value:
+        A single typed value of a column.  Values are stored
+        in records in their binary form (8 bytes for an int64
+        or double, 4 bytes for a date or dict, n bytes for a
+        char(n)) and are the keys of the column indices, so
+        values of a column compare by number or by date rather
+        than as strings.
+
+        A dict Value is the code of its string.  The Table
+        turns strings into codes and back with the column's
+        dictionary.
+
+FieldType:
+    FieldType()
+        Postcondition: A varchar type has been created.
+
+    static bool parse(const std::string& name, FieldType& type)
+        Postcondition: type holds the type written as name.  Returns
+                       false if name isn't a type.
+
+    std::string name() const
+        Postcondition: The type has been returned as it's written in
+                       a make table command.
+
+Value:
+    Value()
+        Postcondition: An empty varchar value has been created.
+
+    static bool parse(const FieldType& type, const std::string& text, Value& value)
+        Postcondition: value holds text read as a value of type.  Returns
+                       false if text isn't a valid value of type.
+
+    static Value decode(const FieldType& type, const char* data, int length)
+        Precondition: data holds length bytes written by encode().
+        Postcondition: The value has been returned.
+
+    std::string encode(const FieldType& type) const
+        Postcondition: The binary form of the value has been returned.
+
+    std::string to_string() const
+        Postcondition: The value has been returned as text in the form
+                       parse() reads.
+
+    int64_t to_int() const
+        Postcondition: The number of an int64, the days since 1970-01-01
+                       of a date or the code of a dict has been returned.
+
+    std::size_t hash() const
+        Postcondition: A hash of the value has been returned.  Values
+                       which are equal have the same hash.
+
+    Comparison operators:
+        Postcondition: Values of the same type compare as numbers,
+                       dates or strings.
+
+*/
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <string>
+#include <stdint.h>
+
+class FieldType
+{
+public:
+    // TYPES
+    enum { VARCHAR, CHAR, INT64, DOUBLE, DATE, DICT };
+
+    // CONSTRUCTORS
+    FieldType() : type(VARCHAR), length(0) {}
+
+    static bool parse(const std::string& name, FieldType& type);
+    std::string name() const;
+
+    // type is one of the TYPES.  length is the size of a
+    // char(n) or the most a varchar(n) may hold, 0 if the
+    // varchar has no limit.
+    int type;
+    int length;
+};
+
+bool FieldType::parse(const std::string& name, FieldType& field_type)
+{
+    std::string base;
+    std::size_t open;
+    long length;
+    char* end;
+
+    length = 0;
+    open = name.find('(');
+    base = name.substr(0, open);
+
+    // Reads the length of a char(n) or varchar(n)
+    if (open != std::string::npos)
+    {
+        if (name[name.size() - 1] != ')')
+            return false;
+
+        length = strtol(name.c_str() + open + 1, &end, 10);
+
+        if (end != name.c_str() + name.size() - 1 || length <= 0 || length > 4000)
+            return false;
+    }
+
+    if (base == "varchar" || base == "string")
+        field_type.type = VARCHAR;
+    else if (base == "char" && open != std::string::npos)
+        field_type.type = CHAR;
+    else if (open != std::string::npos)
+        return false;
+    else if (base == "int64" || base == "int" || base == "integer")
+        field_type.type = INT64;
+    else if (base == "double" || base == "decimal")
+        field_type.type = DOUBLE;
+    else if (base == "date")
+        field_type.type = DATE;
+    else if (base == "dict" || base == "dictionary")
+        field_type.type = DICT;
+    else
+        return false;
+
+    field_type.length = length;
+    return true;
+}
+
+std::string FieldType::name() const
+{
+    char length_str[16];
+    snprintf(length_str, sizeof(length_str), "(%d)", length);
+
+    switch (type)
+    {
+    case INT64:
+        return "int64";
+    case DOUBLE:
+        return "double";
+    case DATE:
+        return "date";
+    case DICT:
+        return "dict";
+    case CHAR:
+        return std::string("char") + length_str;
+    default:
+        return length > 0 ? std::string("varchar") + length_str : "varchar";
+    }
+}
+
+class Value
+{
+public:
+    // CONSTRUCTORS
+    Value() : value_type(FieldType::VARCHAR), int_value(0), double_value(0) {}
+
+    static bool parse(const FieldType& type, const std::string& text, Value& value);
+    static Value decode(const FieldType& type, const char* data, int length);
+
+    // ACCESSORS
+    int type() const { return value_type; }
+    std::string encode(const FieldType& type) const;
+    std::string to_string() const;
+    int64_t to_int() const { return int_value; }
+    std::size_t hash() const;
+
+    // COMPARISON OPERATORS
+    friend bool operator ==(const Value& lhs, const Value& rhs) { return lhs.compare(rhs) == 0; }
+    friend bool operator !=(const Value& lhs, const Value& rhs) { return lhs.compare(rhs) != 0; }
+    friend bool operator < (const Value& lhs, const Value& rhs) { return lhs.compare(rhs) < 0; }
+    friend bool operator <=(const Value& lhs, const Value& rhs) { return lhs.compare(rhs) <= 0; }
+    friend bool operator > (const Value& lhs, const Value& rhs) { return lhs.compare(rhs) > 0; }
+    friend bool operator >=(const Value& lhs, const Value& rhs) { return lhs.compare(rhs) >= 0; }
+
+    // PRINT FUNCTION
+    friend std::ostream& operator <<(std::ostream& outs, const Value& print_me)
+    {
+        outs << print_me.to_string();
+        return outs;
+    }
+
+private:
+    // Only the member for value_type is used.  Dates
+    // are held in int_value as days since 1970-01-01.
+    int value_type;
+    int64_t int_value;
+    double double_value;
+    std::string str_value;
+
+    int compare(const Value& other) const;
+
+    static bool parse_date(const std::string& text, int64_t& days);
+    static std::string format_date(int64_t days);
+};
+
+bool Value::parse(const FieldType& type, const std::string& text, Value& value)
+{
+    char* end;
+
+    value = Value();
+    value.value_type = type.type;
+    errno = 0;
+
+    switch (type.type)
+    {
+    case FieldType::INT64:
+    case FieldType::DICT:
+        value.int_value = strtoll(text.c_str(), &end, 10);
+        return !text.empty() && *end == '\0' && errno != ERANGE;
+
+    case FieldType::DOUBLE:
+        value.double_value = strtod(text.c_str(), &end);
+        return !text.empty() && *end == '\0' && std::isfinite(value.double_value);
+
+    case FieldType::DATE:
+        return parse_date(text, value.int_value);
+
+    case FieldType::CHAR:
+        // Shorter strings are padded with spaces when they're
+        // stored, so the padding is never part of the value
+        value.str_value = text.substr(0, text.find_last_not_of(' ') + 1);
+        return (int)text.size() <= type.length;
+
+    default:
+        value.str_value = text;
+        return type.length == 0 || (int)text.size() <= type.length;
+    }
+}
+
+Value Value::decode(const FieldType& type, const char* data, int length)
+{
+    Value value;
+    int32_t days;
+    uint32_t code;
+
+    value.value_type = type.type;
+
+    switch (type.type)
+    {
+    case FieldType::INT64:
+        memcpy(&value.int_value, data, sizeof(value.int_value));
+        break;
+    case FieldType::DOUBLE:
+        memcpy(&value.double_value, data, sizeof(value.double_value));
+        break;
+    case FieldType::DATE:
+        memcpy(&days, data, sizeof(days));
+        value.int_value = days;
+        break;
+    case FieldType::DICT:
+        memcpy(&code, data, sizeof(code));
+        value.int_value = code;
+        break;
+    case FieldType::CHAR:
+        while (length > 0 && data[length - 1] == ' ')
+            length--;
+        value.str_value.assign(data, length);
+        break;
+    default:
+        value.str_value.assign(data, length);
+        break;
+    }
+
+    return value;
+}
+
+std::string Value::encode(const FieldType& type) const
+{
+    int32_t days;
+    uint32_t code;
+
+    switch (type.type)
+    {
+    case FieldType::INT64:
+        return std::string((const char*)&int_value, sizeof(int_value));
+    case FieldType::DOUBLE:
+        return std::string((const char*)&double_value, sizeof(double_value));
+    case FieldType::DATE:
+        days = int_value;
+        return std::string((const char*)&days, sizeof(days));
+    case FieldType::DICT:
+        code = int_value;
+        return std::string((const char*)&code, sizeof(code));
+    case FieldType::CHAR:
+        return str_value + std::string(type.length - str_value.size(), ' ');
+    default:
+        return str_value;
+    }
+}
+
+std::string Value::to_string() const
+{
+    char buffer[32];
+
+    switch (value_type)
+    {
+    case FieldType::INT64:
+    case FieldType::DICT:
+        snprintf(buffer, sizeof(buffer), "%lld", (long long)int_value);
+        return buffer;
+
+    case FieldType::DOUBLE:
+        // The shortest form which reads back as the same double
+        snprintf(buffer, sizeof(buffer), "%.15g", double_value);
+        if (strtod(buffer, NULL) != double_value)
+            snprintf(buffer, sizeof(buffer), "%.17g", double_value);
+        return buffer;
+
+    case FieldType::DATE:
+        return format_date(int_value);
+
+    default:
+        return str_value;
+    }
+}
+
+std::size_t Value::hash() const
+{
+    uint64_t bits;
+
+    switch (value_type)
+    {
+    case FieldType::INT64:
+    case FieldType::DATE:
+    case FieldType::DICT:
+        bits = (uint64_t)int_value;
+        break;
+    case FieldType::DOUBLE:
+        // 0.0 and -0.0 are equal so they hash the same
+        bits = 0;
+
+        if (double_value != 0)
+            memcpy(&bits, &double_value, sizeof(bits));
+        break;
+    default:
+        // FNV-1a over the bytes of the string
+        bits = 14695981039346656037ULL;
+
+        for (std::size_t i = 0; i < str_value.size(); i++)
+            bits = (bits ^ (unsigned char)str_value[i]) * 1099511628211ULL;
+        break;
+    }
+
+    // Mixes the bits so numbers which differ only
+    // in their high bits land in different buckets
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+
+    return (std::size_t)bits;
+}
+
+int Value::compare(const Value& other) const
+{
+    if (value_type != other.value_type)
+        return value_type < other.value_type ? -1 : 1;
+
+    switch (value_type)
+    {
+    case FieldType::INT64:
+    case FieldType::DATE:
+    case FieldType::DICT:
+        return (int_value > other.int_value) - (int_value < other.int_value);
+    case FieldType::DOUBLE:
+        return (double_value > other.double_value) - (double_value < other.double_value);
+    default:
+        return str_value.compare(other.str_value);
+    }
+}
+
+bool Value::parse_date(const std::string& text, int64_t& days)
+{
+    int year;
+    int month;
+    int day;
+    int month_days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int era;
+    int year_of_era;
+    int day_of_year;
+    int day_of_era;
+    char extra;
+
+    if (sscanf(text.c_str(), "%4d-%2d-%2d%c", &year, &month, &day, &extra) != 3 ||
+        text.size() != 10 || month < 1 || month > 12 || day < 1)
+        return false;
+
+    if (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))
+        month_days[1] = 29;
+
+    if (day > month_days[month - 1])
+        return false;
+
+    // Counts the days from 1970-01-01 using a calendar which
+    // starts in March so the leap day falls at the end of a year
+    year -= (month <= 2);
+    era = (year >= 0 ? year : year - 399) / 400;
+    year_of_era = year - era * 400;
+    day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    days = (int64_t)era * 146097 + day_of_era - 719468;
+
+    return true;
+}
+
+std::string Value::format_date(int64_t days)
+{
+    int64_t era;
+    int day_of_era;
+    int year_of_era;
+    int day_of_year;
+    int mp;
+    int year;
+    int month;
+    int day;
+    char buffer[40];
+
+    // The inverse of the count in parse_date()
+    days += 719468;
+    era = (days >= 0 ? days : days - 146096) / 146097;
+    day_of_era = days - era * 146097;
+    year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    mp = (5 * day_of_year + 2) / 153;
+    day = day_of_year - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = year_of_era + era * 400 + (month <= 2);
+
+    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", year, month, day);
+    return buffer;
+}
+
+#endif
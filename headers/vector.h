@@ -11,28 +11,41 @@
  ********************************************************
 FILE: vector.h
 
-CLASS PROVIDED: List
-    A general list class using linked list functions.
+CLASS PROVIDED: Vector<Item, Inline>
+    A general dynamic array.  Only the items which are in the
+    Vector are constructed, so memory for items is reserved
+    without making any.  An empty Vector holds no memory until
+    the first item is added.
+
+    A Vector with an Inline count above 0 keeps up to that many
+    items inside itself and only takes memory from the heap once
+    it grows past them, for vectors which are almost always
+    small.  Inline defaults to 0.
 
 VALUE SEMANTICS:
     The Copy constructor and assignment operator may be used with
-    this class. 
+    this class.  A Vector which is moved hands over its memory
+    rather than copying its items, and is left empty.
 
 CONSTRUCTORS:
     Vector()
         Postcondition: An empty vector has been instantiated.
 
-    Vector(const Vector<Item>& other)
-        Precondition: other is a Vector<Item> object.
+    Vector(const Vector<Item, Inline>& other)
+        Precondition: other is a Vector<Item, Inline> object.
         Postcondition: The calling object is now an identical but distinct copy of
                        other.
 
+    Vector(Vector<Item, Inline>&& other)
+        Postcondition: The calling object holds the items other held and
+                       other is empty.
+
 ACCESSORS:
     std::size_t size()
         Postcondition: The number of elements stored in the calling object
                        has been returned as a std::size_t type.
 
-    std::size_t size()
+    std::size_t capacity()
         Postcondition: The current element capacity of the calling object has been returned
                        as a std::size_t type.
                        
@@ -51,15 +64,30 @@ ACCESSORS:
                        a const Vector.
 
 MUTATORS:
+    void clear()
+        Postcondition: The vector contains no elements.  Its capacity is
+                       kept for the items added after.
+
     void reserve(std::size_t n)
         Postcondition: The vector now contains enough capacity to hold
                        at least n elements. Can be used to increase efficiency
                        by avoiding excessive resizing.
 
-    void push_back(Item new_item)
+    void push_back(const Item& new_item) *** has move version ***
         Postcondition: _data[size - 1] now contains new_item. _size has been 
                        incremented to reflect the added element.
 
+    void emplace_back(Args&&... args)
+        Postcondition: An Item made from args has been added to the end, in
+                       place.
+
+    void append(const Item* first, const Item* last)
+        Postcondition: The items from first up to last have been added to
+                       the end, making room for them all at once.
+
+    void operator +=(const Vector<Item, Inline>& new_vector)
+        Postcondition: The items of new_vector have been added to the end.
+
     void swap(unsigned int first, unsigned int second)
         Precondition: first and second are less than _size.
         Postcondition: The items stored in _data[first] and _data[second]
@@ -79,20 +107,50 @@ MUTATORS:
 #include <cstdlib>
 #include <assert.h>
 #include <algorithm>
+#include <new>
+#include <utility>
 
 
 namespace jmiller
 {
+    // The room for the Inline items of a Vector, kept in the
+    // Vector itself.  The union lines the bytes up for any Item.
+    template <class Item, int Inline>
+    class VectorBuffer
+    {
+        protected:
+            Item* inline_items() const { return (Item*)_inline.bytes; }
+
+        private:
+            union
+            {
+                char bytes[Inline * sizeof(Item)];
+                long double align_float;
+                long long align_int;
+                void* align_pointer;
+            } _inline;
+    };
+
+    // A Vector without inline items takes no room for them
     template <class Item>
-    class Vector
+    class VectorBuffer<Item, 0>
+    {
+        protected:
+            Item* inline_items() const { return NULL; }
+    };
+
+    template <class Item, int Inline = 0>
+    class Vector : private VectorBuffer<Item, Inline>
     {
         public:
             // CONSTRUCTORS
-            Vector(): _size(0), _capacity(MIN_CAP), _data(new Item [MIN_CAP]) {}
-            Vector(const Vector<Item>& other);
+            Vector(): _size(0), _capacity(Inline), _data(this->inline_items()) {}
+            Vector(const Vector<Item, Inline>& other);
+            Vector(Vector<Item, Inline>&& other);
 
             // ASSIGNMENT OPERATOR
-            Vector<Item>& operator =(const Vector<Item>& rhs);
+            Vector<Item, Inline>& operator =(const Vector<Item, Inline>& rhs);
+            Vector<Item, Inline>& operator =(Vector<Item, Inline>&& rhs);
 
             // DESTRUCTOR
             ~Vector();
@@ -101,21 +159,26 @@ namespace jmiller
             unsigned int size() const { return _size; }
             unsigned int capacity() const { return _capacity; }
             unsigned int max_capacity() const { return SIZE_MAX; }
-            bool empty() { return _size == 0; }
+            bool empty() const { return _size == 0; }
             Item& operator[](int index) { return _data[index]; }
             const Item& operator[](int index) const { return _data[index]; }
 
             // MUTATORS
-            void clear() { _size = 0; }
+            void clear();
             void reserve(std::size_t n);
-            void push_back(Item new_item);
-            void operator +=(Item new_item);
-            void operator +=(Vector<Item> new_vector);
+            void push_back(const Item& new_item) { emplace_back(new_item); }
+            void push_back(Item&& new_item) { emplace_back(std::move(new_item)); }
+            template <class... Args>
+            void emplace_back(Args&&... args);
+            void append(const Item* first, const Item* last);
+            void operator +=(const Item& new_item) { emplace_back(new_item); }
+            void operator +=(Item&& new_item) { emplace_back(std::move(new_item)); }
+            void operator +=(const Vector<Item, Inline>& new_vector);
             void swap(unsigned int first, unsigned int second);
             Item pop_back();
 
             friend std::ostream& operator<<(std::ostream& outs,
-                                            const Vector<Item>& print_me)
+                                            const Vector<Item, Inline>& print_me)
             {
                 outs << "{ ";
                 for (int i = 0; i < print_me.size(); i++)
@@ -133,135 +196,285 @@ namespace jmiller
             Item* _data;
 
             // HELPER FUNCTIONS
-            void resize();
+            bool on_heap() const { return _data != this->inline_items(); }
+            template <class... Args>
+            void grow_and_emplace(Args&&... args);
+            void reallocate(std::size_t capacity);
+            void move_items(Item* to);
+            void take(Vector<Item, Inline>& other);
+            void release();
             void shrink_to_fit();
 
     };
 
-    template<class Item>
-    jmiller::Vector<Item>::Vector(const Vector<Item>& other)
+    template<class Item, int Inline>
+    jmiller::Vector<Item, Inline>::Vector(const Vector<Item, Inline>& other)
+        : _size(0), _capacity(Inline), _data(this->inline_items())
     {
+        if (other._size > _capacity)
+            reallocate(other._size);
+
+        for (std::size_t i = 0; i < other._size; i++)
+            new (_data + i) Item(other._data[i]);
+
         _size = other._size;
-        _capacity = other._capacity;
+    }
+
+    template<class Item, int Inline>
+    jmiller::Vector<Item, Inline>::Vector(Vector<Item, Inline>&& other)
+        : _size(0), _capacity(Inline), _data(this->inline_items())
+    {
+        take(other);
+    }
+
+    template<class Item, int Inline>
+    jmiller::Vector<Item, Inline>& jmiller::Vector<Item, Inline>::operator =(const Vector<Item, Inline>& rhs)
+    {
+        std::size_t common;
+
+        if (this == &rhs)
+            return *this;
 
-        _data = new Item[_capacity];
+        // The items are only moved to new memory when
+        // there isn't room for rhs in the old
+        if (rhs._size > _capacity)
+        {
+            clear();
+            reallocate(rhs._size);
+        }
 
-        std::copy(other._data, other._data + _size, _data);
+        // Items both have are assigned, the rest of rhs is
+        // copied in and the rest of this is destroyed
+        common = std::min(_size, rhs._size);
+        std::copy(rhs._data, rhs._data + common, _data);
+
+        for (std::size_t i = common; i < rhs._size; i++)
+            new (_data + i) Item(rhs._data[i]);
+
+        for (std::size_t i = rhs._size; i < _size; i++)
+            _data[i].~Item();
+
+        _size = rhs._size;
+
+        return *this;
     }
 
-    template<class Item>
-    jmiller::Vector<Item>& jmiller::Vector<Item>::operator =(const Vector<Item>& rhs)
+    template<class Item, int Inline>
+    jmiller::Vector<Item, Inline>& jmiller::Vector<Item, Inline>::operator =(Vector<Item, Inline>&& rhs)
     {
-        delete[] this->_data;
+        if (this == &rhs)
+            return *this;
 
-        this->_size = rhs._size;
-        this->_capacity = rhs._capacity;
+        release();
+        take(rhs);
 
-        this->_data = new Item[_capacity];
+        return *this;
+    }
 
-        std::copy(rhs._data, rhs._data + _size, _data);
+    template<class Item, int Inline>
+    jmiller::Vector<Item, Inline>::~Vector()
+    {
+        release();
     }
 
-    template<class Item>
-    jmiller::Vector<Item>::~Vector()
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::clear()
     {
-        delete[] _data;
+        for (std::size_t i = 0; i < _size; i++)
+            _data[i].~Item();
+
+        _size = 0;
     }
 
-    template<class Item>
-    void jmiller::Vector<Item>::push_back(Item new_item)
+    template<class Item, int Inline>
+    template<class... Args>
+    void jmiller::Vector<Item, Inline>::emplace_back(Args&&... args)
     {
         if (_size == _capacity)
-            this->resize();
+        {
+            grow_and_emplace(std::forward<Args>(args)...);
+            return;
+        }
 
-        _data[_size++] = new_item;
+        new (_data + _size) Item(std::forward<Args>(args)...);
+        _size++;
     }
 
-    template<typename Item>
-    void jmiller::Vector<Item>::operator+=(Item new_Item)
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::append(const Item* first, const Item* last)
     {
-        push_back(new_Item);
+        std::size_t count;
+        std::size_t offset;
+        bool own;
+
+        count = last - first;
+
+        // A range of this vector's own items is found
+        // again after they move to new memory
+        own = _size > 0 && first >= _data && first < _data + _size;
+        offset = own ? first - _data : 0;
+
+        reserve(_size + count);
+
+        if (own)
+            first = _data + offset;
+
+        for (std::size_t i = 0; i < count; i++)
+            new (_data + _size + i) Item(first[i]);
+
+        _size += count;
     }
 
-    template<typename Item>
-    void jmiller::Vector<Item>::operator+=(Vector<Item> new_vector)
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::operator+=(const Vector<Item, Inline>& new_vector)
     {
-        for(int i = 0; i < new_vector.size(); i++)
-            push_back(new_vector[i]);
+        append(new_vector._data, new_vector._data + new_vector._size);
     }
 
-    template<class Item>
-    Item jmiller::Vector<Item>::pop_back()
+    template<class Item, int Inline>
+    Item jmiller::Vector<Item, Inline>::pop_back()
     {
         assert(_size > 0);
 
+        Item last(std::move(_data[_size - 1]));
+        _data[--_size].~Item();
+
         if (_size <= _capacity / 4 && _capacity > MIN_CAP)
             this->shrink_to_fit();
 
-        return _data[--_size];
+        return last;
     }
 
-    template<class Item>
-    void jmiller::Vector<Item>::reserve(std::size_t n)
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::reserve(std::size_t n)
     {
-        while (n > _capacity)
-            _capacity *= 2;
+        std::size_t capacity;
 
-        // Creat new temporary array
-        Item* temp;
-        temp = new Item[_capacity];
+        if (n <= _capacity)
+            return;
 
-        // Copy current Vector elements into temp
-        std::copy( _data, _data + _size, temp);
+        capacity = _capacity < MIN_CAP ? MIN_CAP : _capacity;
 
-        // Dealocate memory used by _data and set _data to temp
-        delete[] _data;
-        _data = temp;
+        while (n > capacity)
+            capacity *= 2;
+
+        reallocate(capacity);
     }
 
-    template<class Item>
-    void jmiller::Vector<Item>::resize()
+    template<class Item, int Inline>
+    template<class... Args>
+    void jmiller::Vector<Item, Inline>::grow_and_emplace(Args&&... args)
     {
+        std::size_t capacity;
+        Item* temp;
+
         // Double the vectors capacity
-        _capacity *= 2;
+        capacity = _capacity < MIN_CAP / 2 ? MIN_CAP : _capacity * 2;
+        temp = (Item*)::operator new(capacity * sizeof(Item));
+
+        // The new item is made before the others move, since
+        // args may be one of them
+        new (temp + _size) Item(std::forward<Args>(args)...);
+        move_items(temp);
 
-        // Creat new temporary array
+        _data = temp;
+        _capacity = capacity;
+        _size++;
+    }
+
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::reallocate(std::size_t capacity)
+    {
         Item* temp;
-        temp = new Item[_capacity];
 
-        // Copy current Vector elements into temp
-        std::copy( _data, _data + _size, temp);
+        // Items which fit go back inside the vector
+        if (capacity <= Inline)
+        {
+            if (!on_heap())
+                return;
+
+            temp = this->inline_items();
+            capacity = Inline;
+        }
+        else
+            temp = (Item*)::operator new(capacity * sizeof(Item));
+
+        move_items(temp);
 
-        // Dealocate memory used by _data and set _data to temp
-        delete[] _data;
         _data = temp;
+        _capacity = capacity;
     }
 
-    template<class Item>
-    void jmiller::Vector<Item>::shrink_to_fit()
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::move_items(Item* to)
     {
-        while (_capacity / 2 > _size && _capacity / 2 > MIN_CAP)
-            _capacity /= 2;        
+        // Moves the items to new memory and frees the old
+        for (std::size_t i = 0; i < _size; i++)
+        {
+            new (to + i) Item(std::move(_data[i]));
+            _data[i].~Item();
+        }
+
+        if (on_heap())
+            ::operator delete(_data);
+    }
 
-        Item* temp;
-        temp = new Item[_capacity];
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::take(Vector<Item, Inline>& other)
+    {
+        // The memory of other is handed over whole, but
+        // inline items have to be moved one by one
+        if (other.on_heap())
+        {
+            _data = other._data;
+            _capacity = other._capacity;
+            _size = other._size;
+
+            other._data = other.inline_items();
+            other._capacity = Inline;
+            other._size = 0;
+        }
+        else
+        {
+            for (std::size_t i = 0; i < other._size; i++)
+                new (_data + i) Item(std::move(other._data[i]));
+
+            _size = other._size;
+            other.clear();
+        }
+    }
 
-        std::copy( _data, _data + _size, temp);
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::release()
+    {
+        clear();
 
-        delete[] _data;
-        _data = temp;
+        if (on_heap())
+            ::operator delete(_data);
+
+        _data = this->inline_items();
+        _capacity = Inline;
     }
 
-    template<class Item>
-    void jmiller::Vector<Item>::swap(unsigned int first, unsigned int second)
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::shrink_to_fit()
     {
-        assert(first < _size && second < _size);
+        std::size_t capacity;
+
+        capacity = _capacity;
+
+        while (capacity / 2 > _size && capacity / 2 > MIN_CAP)
+            capacity /= 2;        
 
-        Item temp;
-        temp = _data[first];
+        reallocate(capacity);
+    }
+
+    template<class Item, int Inline>
+    void jmiller::Vector<Item, Inline>::swap(unsigned int first, unsigned int second)
+    {
+        assert(first < _size && second < _size);
 
-        _data[first] = _data[second];
-        _data[second] = temp;
+        std::swap(_data[first], _data[second]);
     }
 }
 
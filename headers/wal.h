@@ -0,0 +1,647 @@
+/*********************************************************
+ *   AUTHOR        : Jordan Miller
+ *
+ *   PROJECT       : Relational Database
+ *
+ *   PURPOSE       : Relatinal database management system
+ *                   using B+ Tree indexing with SQL command
+ *                   interface
+ *
+ *   Copyright (c) 2019, Jordan Miller
+ ********************************************************
+FILE: wal.h
+
+CLASSES PROVIDED:
+    WriteAheadLog:
+        An append only log of the changes made to one table.
+        A change is logged when it is made to a page in the
+        buffer pool, so the table's pages only need to be
+        written to their file at a checkpoint.  If the program
+        stops before then, the log is replayed into the table
+        the next time it is opened.
+
+    LogManager:
+        Keeps the log of every table open and decides when
+        logged changes are forced to disk (the commit policy)
+        and when a table is checkpointed.  Whatever the
+        policy, a log is forced before the buffer pool writes
+        back a changed page of a file it covers.
+
+LOG RECORD FORMAT:
+    [length : 4 bytes][type : 1 byte][rid : 8 bytes][record][checksum : 4 bytes]
+
+    length is the size of the record bytes.  A log record
+    whose checksum doesn't match was only partly written
+    when the program stopped, so it and anything after it
+    are dropped.
+
+    A log starts with a CHECKPOINT record whose rid is the
+    epoch of the checkpoint which emptied it (see catalog.h).
+
+COMMIT POLICIES:
+    COMMIT_STATEMENT
+        Every statement's log records are forced to disk
+        before the next statement runs.
+    COMMIT_GROUP
+        Log records are forced to disk once group_bytes have
+        built up or group_ms have passed since the last time,
+        so the cost of forcing is shared by many statements.
+        The time is only checked when a statement commits, so
+        the records of the last statements are forced by
+        sync() when there are no more, i.e. when a batch or
+        session ends.
+    COMMIT_ASYNC
+        Log records are handed to the operating system after
+        every statement but never forced.
+
+WriteAheadLog:
+    WriteAheadLog(const std::string& file_name, const std::string& table_file)
+        Postcondition: The log file has been opened, and created if it
+                       didn't exist.  table_file is the table it logs.
+
+    void cover(const std::string& data_file)
+        Postcondition: data_file is written back along with the table
+                       when the log is checkpointed.
+
+    bool append(int type, long rid, const char* data, int length)
+        Postcondition: A log record has been added to the end of the log.
+
+    void rewind()
+    bool next(int& type, long& rid, std::string& data)
+        Postcondition: next() returns the log records in the order they
+                       were written, starting from the beginning of the
+                       log after rewind().  Returns false at the end of
+                       the log.
+
+    void flush()
+        Postcondition: The log records have been handed to the
+                       operating system.
+
+    void sync()
+        Postcondition: The log records have been forced to disk.
+
+    uint64_t epoch() const
+        Postcondition: The epoch in the log's CHECKPOINT record has been
+                       returned, or 0 if it doesn't have one.
+
+    void truncate()
+        Postcondition: The log is empty.
+
+    void restart(uint64_t epoch)
+        Postcondition: The log holds nothing but a CHECKPOINT record
+                       for epoch.
+
+LogManager:
+    LogManager(BufferPool& pool)
+        Postcondition: A LogManager which checkpoints tables through
+                       pool has been created.  It is pool's write back
+                       hook until it's destroyed.
+
+    WriteAheadLog* open(const std::string& file_name,
+                        const std::string& table_file, bool& is_new)
+        Postcondition: The log has been returned.  is_new is true if
+                       it wasn't open before, in which case it may hold
+                       changes which need to be replayed.
+
+    WriteAheadLog* create(const std::string& file_name, const std::string& table_file)
+        Postcondition: The log has been opened and emptied.
+
+    void commit()
+        Postcondition: The commit policy has been applied to every log
+                       with new records and any log which has grown
+                       past CHECKPOINT_BYTES has been checkpointed.
+
+    void sync()
+        Postcondition: Every log has been forced to disk, whatever the
+                       commit policy.
+
+    bool synced() const
+        Postcondition: A bool indicating if every log record is on disk
+                       has been returned.
+
+    void checkpoint(WriteAheadLog* log)
+        Postcondition: The log's table pages have been written back and
+                       forced to disk, the checkpoint hook has been told
+                       and the log has been restarted with the epoch it
+                       returned.
+
+    void set_checkpoint_hook(CheckpointHook hook)
+        Postcondition: hook is called with the table file of every log
+                       checkpointed.  It returns the checkpoint's epoch.
+
+    void set_policy(CommitPolicy policy, long group_bytes, long group_ms)
+        Postcondition: The commit policy has been changed.
+
+*/
+#ifndef WAL_H
+#define WAL_H
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <chrono>
+#include <stdint.h>
+#include "./buffer_pool.h"
+#include "./map.h"
+#include "./vector.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Called with a table file when it's checkpointed
+typedef uint64_t (*CheckpointHook)(const std::string& table_file);
+
+enum CommitPolicy { COMMIT_STATEMENT, COMMIT_GROUP, COMMIT_ASYNC };
+
+// Forces the data of an open file to disk
+void sync_file(FILE* file)
+{
+    fflush(file);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+}
+
+// Forces the data of a file written through another
+// stream, such as a table file in the buffer pool, to disk
+void sync_file(const std::string& file_name)
+{
+#ifdef _WIN32
+    int fd = _open(file_name.c_str(), _O_RDWR | _O_BINARY);
+    if (fd >= 0)
+    {
+        _commit(fd);
+        _close(fd);
+    }
+#else
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        fsync(fd);
+        ::close(fd);
+    }
+#endif
+}
+
+class WriteAheadLog
+{
+public:
+    // LOG RECORD TYPES
+    // A LOAD record marks a bulk load whose pages were
+    // written to the table without being logged.  A
+    // CHECKPOINT record starts the log.  A DELETE record
+    // has no record bytes, only the rid deleted.  An
+    // UPDATE record holds the whole record as it is after
+    // the update, written over the one at its rid.  An
+    // INDEX record holds a field number and a key the record
+    // at its rid was indexed under, logged ahead of the
+    // delete or update which takes it out of the index.
+    enum { INSERT = 1, LOAD = 2, CHECKPOINT = 3, DELETE = 4, UPDATE = 5, INDEX = 6 };
+
+    // CONSTRUCTORS
+    WriteAheadLog(const std::string& file_name, const std::string& table_file);
+
+    // DESTRUCTOR
+    ~WriteAheadLog();
+
+    // ACCESSORS
+    const std::string& table_file() const { return table_name; }
+    const jmiller::Vector<std::string>& data_files() const { return data_names; }
+    long size() const { return log_size; }
+    long unsynced() const { return unsynced_bytes; }
+    bool has_unflushed() const { return unflushed; }
+    uint64_t epoch() const { return log_epoch; }
+
+    // MUTATORS
+    void cover(const std::string& data_file);
+    bool append(int type, long rid, const char* data, int length);
+    void rewind();
+    bool next(int& type, long& rid, std::string& data);
+    void flush();
+    void sync();
+    void truncate();
+    void restart(uint64_t epoch);
+
+private:
+    std::string file_name;
+    std::string table_name;
+    jmiller::Vector<std::string> data_names;
+    FILE* file;
+    long log_size;
+    long read_pos;
+    long unsynced_bytes;
+    bool unflushed;
+    uint64_t log_epoch;
+
+    // A log can't be copied
+    WriteAheadLog(const WriteAheadLog& other);
+    WriteAheadLog& operator =(const WriteAheadLog& rhs);
+
+    static uint32_t checksum(int type, long rid, const char* data, int length);
+    void truncate_at(long size);
+};
+
+WriteAheadLog::WriteAheadLog(const std::string& name, const std::string& table_file)
+{
+    std::string data;
+    int type;
+    long rid;
+
+    file_name = name;
+    table_name = table_file;
+    read_pos = 0;
+    unsynced_bytes = 0;
+    unflushed = false;
+    log_epoch = 0;
+
+    // Opened for reading anywhere and appending to the end
+    file = fopen(file_name.c_str(), "a+b");
+    fseek(file, 0, SEEK_END);
+    log_size = ftell(file);
+
+    // The epoch is in the first record
+    if (next(type, rid, data) && type == CHECKPOINT)
+        log_epoch = rid;
+
+    rewind();
+}
+
+WriteAheadLog::~WriteAheadLog()
+{
+    if (file != NULL)
+    {
+        sync_file(file);
+        fclose(file);
+    }
+}
+
+void WriteAheadLog::cover(const std::string& data_file)
+{
+    for (int i = 0; i < data_names.size(); i++)
+        if (data_names[i] == data_file)
+            return;
+
+    data_names.push_back(data_file);
+}
+
+bool WriteAheadLog::append(int type, long rid, const char* data, int length)
+{
+    uint32_t data_length;
+    uint8_t record_type;
+    uint64_t record_id;
+    uint32_t sum;
+
+    data_length = length;
+    record_type = type;
+    record_id = rid;
+    sum = checksum(type, rid, data, length);
+
+    fseek(file, 0, SEEK_END);
+
+    if (fwrite(&data_length, sizeof(data_length), 1, file) != 1 ||
+        fwrite(&record_type, sizeof(record_type), 1, file) != 1 ||
+        fwrite(&record_id, sizeof(record_id), 1, file) != 1 ||
+        (length > 0 && fwrite(data, 1, length, file) != (size_t)length) ||
+        fwrite(&sum, sizeof(sum), 1, file) != 1)
+        return false;
+
+    length += sizeof(data_length) + sizeof(record_type) + sizeof(record_id) + sizeof(sum);
+    log_size += length;
+    unsynced_bytes += length;
+    unflushed = true;
+
+    return true;
+}
+
+void WriteAheadLog::rewind()
+{
+    read_pos = 0;
+}
+
+bool WriteAheadLog::next(int& type, long& rid, std::string& data)
+{
+    uint32_t data_length;
+    uint8_t record_type;
+    uint64_t record_id;
+    uint32_t sum;
+
+    fseek(file, read_pos, SEEK_SET);
+
+    if (fread(&data_length, sizeof(data_length), 1, file) != 1)
+        return false;
+
+    data.resize(data_length);
+
+    if (data_length > (uint32_t)Page::SIZE ||
+        fread(&record_type, sizeof(record_type), 1, file) != 1 ||
+        fread(&record_id, sizeof(record_id), 1, file) != 1 ||
+        (data_length > 0 && fread(&data[0], 1, data_length, file) != data_length) ||
+        fread(&sum, sizeof(sum), 1, file) != 1 ||
+        sum != checksum(record_type, record_id, data.data(), data_length))
+    {
+        // The last record was only partly written.  It's
+        // cut off so new records follow the last good one.
+        truncate_at(read_pos);
+        return false;
+    }
+
+    type = record_type;
+    rid = record_id;
+    read_pos = ftell(file);
+
+    return true;
+}
+
+void WriteAheadLog::flush()
+{
+    fflush(file);
+    unflushed = false;
+}
+
+void WriteAheadLog::sync()
+{
+    sync_file(file);
+    unsynced_bytes = 0;
+    unflushed = false;
+}
+
+void WriteAheadLog::truncate()
+{
+    truncate_at(0);
+    log_epoch = 0;
+}
+
+void WriteAheadLog::restart(uint64_t epoch)
+{
+    truncate();
+    append(CHECKPOINT, epoch, NULL, 0);
+    log_epoch = epoch;
+}
+
+void WriteAheadLog::truncate_at(long size)
+{
+    fflush(file);
+#ifdef _WIN32
+    _chsize(_fileno(file), size);
+#else
+    if (ftruncate(fileno(file), size) != 0)
+        std::cout << "Failed to truncate " << file_name << std::endl;
+#endif
+    fseek(file, 0, SEEK_END);
+
+    log_size = size;
+    read_pos = size;
+    unsynced_bytes = 0;
+}
+
+uint32_t WriteAheadLog::checksum(int type, long rid, const char* data, int length)
+{
+    // FNV-1a over the type, rid and record bytes
+    uint32_t hash;
+    uint64_t record_id;
+    hash = 2166136261u;
+    record_id = rid;
+
+    hash = (hash ^ (uint8_t)type) * 16777619u;
+
+    for (int i = 0; i < 8; i++)
+        hash = (hash ^ (uint8_t)(record_id >> (8 * i))) * 16777619u;
+
+    for (int i = 0; i < length; i++)
+        hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+
+    return hash;
+}
+
+class LogManager
+{
+public:
+    // STATIC MEMBER CONSTANTS
+    static const long CHECKPOINT_BYTES = 4 * 1024 * 1024;
+    static const long GROUP_BYTES = 256 * 1024;
+    static const long GROUP_MS = 50;
+
+    // CONSTRUCTORS
+    LogManager(BufferPool& pool);
+
+    // DESTRUCTOR
+    ~LogManager();
+
+    // ACCESSORS
+    bool synced() const;
+
+    // MUTATORS
+    WriteAheadLog* open(const std::string& file_name,
+                        const std::string& table_file, bool& is_new);
+    WriteAheadLog* create(const std::string& file_name, const std::string& table_file);
+    void commit();
+    void sync();
+    void checkpoint(WriteAheadLog* log);
+    void set_policy(CommitPolicy policy, long group_bytes = GROUP_BYTES,
+                    long group_ms = GROUP_MS);
+    void set_checkpoint_hook(CheckpointHook hook) { checkpoint_hook = hook; }
+
+private:
+    BufferPool& buffer_pool;
+    CheckpointHook checkpoint_hook;
+    jmiller::Vector<WriteAheadLog*> logs;
+    Map<std::string, int> log_ids;
+    CommitPolicy commit_policy;
+    long group_bytes;
+    long group_ms;
+    std::chrono::steady_clock::time_point last_sync;
+
+    // A LogManager can't be copied
+    LogManager(const LogManager& other);
+    LogManager& operator =(const LogManager& rhs);
+
+    static void written_back(void* manager, const std::string& file_name);
+};
+
+LogManager::LogManager(BufferPool& pool) : buffer_pool(pool)
+{
+    checkpoint_hook = NULL;
+    commit_policy = COMMIT_GROUP;
+    group_bytes = GROUP_BYTES;
+    group_ms = GROUP_MS;
+    last_sync = std::chrono::steady_clock::now();
+    buffer_pool.set_write_back_hook(&LogManager::written_back, this);
+}
+
+LogManager::~LogManager()
+{
+    // The pool writes back what's left after this is gone
+    buffer_pool.set_write_back_hook(NULL, NULL);
+
+    // Each log is forced to disk as it is closed
+    for (int i = 0; i < logs.size(); i++)
+        delete logs[i];
+}
+
+WriteAheadLog* LogManager::open(const std::string& file_name,
+                                const std::string& table_file, bool& is_new)
+{
+    is_new = !log_ids.contains(file_name);
+
+    if (!is_new)
+        return logs[log_ids[file_name]];
+
+    log_ids.insert(file_name, logs.size());
+    logs.push_back(new WriteAheadLog(file_name, table_file));
+
+    return logs[logs.size() - 1];
+}
+
+WriteAheadLog* LogManager::create(const std::string& file_name, const std::string& table_file)
+{
+    WriteAheadLog* log;
+    bool is_new;
+
+    log = open(file_name, table_file, is_new);
+    log->truncate();
+
+    return log;
+}
+
+void LogManager::commit()
+{
+    long unsynced;
+    long elapsed;
+    bool force;
+
+    unsynced = 0;
+
+    for (int i = 0; i < logs.size(); i++)
+    {
+        if (logs[i]->has_unflushed())
+            logs[i]->flush();
+
+        unsynced += logs[i]->unsynced();
+    }
+
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - last_sync).count();
+
+    // Decides if the logs are forced to disk now
+    // or left for a later commit to force
+    switch (commit_policy)
+    {
+    case COMMIT_STATEMENT:
+        force = (unsynced > 0);
+        break;
+    case COMMIT_GROUP:
+        force = (unsynced >= group_bytes || (unsynced > 0 && elapsed >= group_ms));
+        break;
+    default:
+        force = false;
+        break;
+    }
+
+    if (force)
+        sync();
+
+    for (int i = 0; i < logs.size(); i++)
+        if (logs[i]->size() >= CHECKPOINT_BYTES)
+            checkpoint(logs[i]);
+}
+
+void LogManager::sync()
+{
+    for (int i = 0; i < logs.size(); i++)
+        if (logs[i]->unsynced() > 0 || logs[i]->has_unflushed())
+            logs[i]->sync();
+
+    last_sync = std::chrono::steady_clock::now();
+}
+
+bool LogManager::synced() const
+{
+    for (int i = 0; i < logs.size(); i++)
+        if (logs[i]->unsynced() > 0 || logs[i]->has_unflushed())
+            return false;
+
+    return true;
+}
+
+void LogManager::checkpoint(WriteAheadLog* log)
+{
+    int file;
+    uint64_t epoch;
+
+    // The table's pages must be on disk before the
+    // log records describing them can be thrown away
+    file = buffer_pool.open_file(log->table_file());
+
+    if (file >= 0)
+    {
+        buffer_pool.flush(file);
+        sync_file(log->table_file());
+    }
+
+    for (int i = 0; i < log->data_files().size(); i++)
+    {
+        file = buffer_pool.open_file(log->data_files()[i]);
+
+        if (file >= 0)
+        {
+            buffer_pool.flush(file);
+            sync_file(log->data_files()[i]);
+        }
+    }
+
+    // The hook records the checkpoint, i.e. in the catalog,
+    // before the log is emptied.  If the program stops in
+    // between, the log's epoch is behind the hook's.
+    epoch = (checkpoint_hook != NULL) ? checkpoint_hook(log->table_file()) : 0;
+
+    if (epoch == 0)
+        epoch = log->epoch() + 1;
+
+    log->restart(epoch);
+    log->sync();
+}
+
+void LogManager::written_back(void* manager, const std::string& file_name)
+{
+    LogManager* self;
+    WriteAheadLog* log;
+    bool covers;
+
+    self = (LogManager*)manager;
+
+    // Forces the log holding the changes of the page about
+    // to be written, unless it's on disk already
+    for (int i = 0; i < self->logs.size(); i++)
+    {
+        log = self->logs[i];
+
+        if (log->unsynced() == 0 && !log->has_unflushed())
+            continue;
+
+        covers = (log->table_file() == file_name);
+
+        for (int j = 0; !covers && j < log->data_files().size(); j++)
+            covers = (log->data_files()[j] == file_name);
+
+        if (covers)
+            log->sync();
+    }
+}
+
+void LogManager::set_policy(CommitPolicy policy, long bytes, long ms)
+{
+    commit_policy = policy;
+    group_bytes = bytes;
+    group_ms = ms;
+}
+
+#endif